@@ -0,0 +1,426 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+
+#include <sys/socket.h> // socket(), connect(), send(), recv()
+#include <sys/epoll.h>  // epoll()
+#include <netinet/in.h> // sockaddr_in
+#include <netinet/tcp.h> // TCP_NODELAY
+#include <arpa/inet.h>  // inet_pton()
+#include <fcntl.h>      // fcntl()
+#include <unistd.h>     // close()
+
+static const char* USAGE =
+  "Usage: ChatLoad [port] [--host=IP] [--conns=N] [--senders=S] [--size=BYTES] [--rate=MSGS]"
+  " [--secs=T] [--warmup=T] [--latency] [--rcvbuf=BYTES] [--connect-only] [--count=N]\n";
+
+// Every message is one line: "<send time ns, 16 hex> <seq, 8 hex> xxx...x\n"
+static constexpr size_t HEADER = 26;
+static constexpr size_t GREETING_MAX = 256;
+// Per event, so a fast peer can't keep the loop off the clock and the other sockets
+static constexpr size_t PUMP_LINES = 64;
+static constexpr size_t DRAIN_READS = 4;
+
+struct Options
+{
+  std::string host = "127.0.0.1";
+  int port = 27015;
+  size_t conns = 16;      // connections, all of them receive
+  size_t senders = 1;     // the first S connections also send
+  size_t size = 64;       // bytes per message, newline included
+  size_t rate = 0;        // msgs/s per sender, 0 = as fast as the sockets take them
+  size_t secs = 5;        // measured window
+  size_t warmup = 1;      // seconds run before the window opens
+  size_t rcvbuf = 0;      // SO_RCVBUF for receivers, 0 = kernel default
+  bool latency = false;   // parse lines and time them, needs one sender
+  bool connectOnly = false; // connect, read the greeting, close, as fast as possible
+  size_t count = 0;       // --connect-only stops after this many cycles, 0 = after --secs
+};
+
+struct Conn
+{
+  int fd = -1;
+
+  // Sender side: bytes of the current line not yet taken by the socket
+  std::string pending;
+  size_t pendingOff = 0;
+  uint32_t seq = 0;
+  uint64_t sentMsgs = 0;
+
+  // Receiver side
+  uint64_t rxBytes = 0;
+  std::string line;
+};
+
+static volatile sig_atomic_t g_stop = 0;
+
+static uint64_t NowNs()
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static bool ParseCount(const std::string& value, size_t& out)
+{
+  if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+
+  errno = 0;
+  unsigned long long v = std::strtoull(value.c_str(), nullptr, 10);
+  if (errno == ERANGE || v > SIZE_MAX)
+    return false;
+
+  out = static_cast<size_t>(v);
+  return true;
+}
+
+static int BadOption(const std::string& arg)
+{
+  std::cerr << "Invalid option: " << arg << "\n" << USAGE;
+  return 1;
+}
+
+static int Connect(const Options& opts)
+{
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(opts.port));
+  if (inet_pton(AF_INET, opts.host.c_str(), &addr.sin_addr) != 1)
+  {
+    std::cerr << "Bad host: " << opts.host << "\n";
+    return -1;
+  }
+
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+  if (fd == -1)
+  {
+    perror("socket");
+    return -1;
+  }
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  if (opts.rcvbuf > 0)
+  {
+    int rb = static_cast<int>(opts.rcvbuf);
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rb, sizeof(rb));
+  }
+
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1)
+  {
+    perror("connect");
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/// <summary>
+/// Reads the server's greeting line, blocking. Returns false on EOF or error.
+/// </summary>
+static bool ReadGreeting(int fd)
+{
+  char c;
+  for (size_t i = 0; i < GREETING_MAX; ++i)
+  {
+    if (recv(fd, &c, 1, 0) != 1)
+      return false;
+    if (c == '\n')
+      return true;
+  }
+  return false;
+}
+
+static void FillLine(Conn& c, size_t size)
+{
+  char head[HEADER + 1];
+  snprintf(head, sizeof(head), "%016llx %08x ", static_cast<unsigned long long>(NowNs()), c.seq++);
+  c.pending.assign(size, 'x');
+  memcpy(&c.pending[0], head, HEADER);
+  c.pending[size - 1] = '\n';
+  c.pendingOff = 0;
+}
+
+/// <summary>
+/// Writes lines until the socket is full, PUMP_LINES went out or, when paced,
+/// the due lines are out. Returns false if the connection failed.
+/// </summary>
+static bool Pump(Conn& c, const Options& opts, uint64_t due)
+{
+  for (size_t lines = 0; lines < PUMP_LINES; )
+  {
+    if (c.pendingOff == c.pending.size())
+    {
+      if (opts.rate > 0 && c.sentMsgs >= due)
+        return true;
+      FillLine(c, opts.size);
+    }
+
+    ssize_t n = send(c.fd, c.pending.data() + c.pendingOff, c.pending.size() - c.pendingOff,
+      MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return true;
+      perror("send");
+      return false;
+    }
+
+    c.pendingOff += static_cast<size_t>(n);
+    if (c.pendingOff == c.pending.size())
+    {
+      ++c.sentMsgs;
+      ++lines;
+    }
+  }
+  return true;
+}
+
+/// <summary>
+/// Drains a receiver. In latency mode every complete line is timed against its header.
+/// </summary>
+static bool Drain(Conn& c, bool measure, bool latency, std::vector<uint32_t>& samples)
+{
+  char buf[65536];
+  for (size_t reads = 0; reads < DRAIN_READS; ++reads)
+  {
+    ssize_t n = recv(c.fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n == 0)
+      return false;
+    if (n < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return true;
+      perror("recv");
+      return false;
+    }
+
+    size_t len = static_cast<size_t>(n);
+    if (measure)
+    {
+      c.rxBytes += len;
+    }
+
+    if (!latency)
+      continue;
+
+    uint64_t now = NowNs();
+    for (size_t i = 0; i < len; ++i)
+    {
+      if (buf[i] != '\n')
+      {
+        c.line.push_back(buf[i]);
+        continue;
+      }
+
+      if (measure && c.line.size() >= HEADER)
+      {
+        uint64_t sent = std::strtoull(c.line.substr(0, 16).c_str(), nullptr, 16);
+        uint64_t us = now > sent ? (now - sent) / 1000 : 0;
+        samples.push_back(static_cast<uint32_t>(std::min<uint64_t>(us, UINT32_MAX)));
+      }
+      c.line.clear();
+    }
+  }
+  return true;
+}
+
+static double Percentile(std::vector<uint32_t>& v, double p)
+{
+  if (v.empty())
+    return 0;
+  size_t idx = static_cast<size_t>(p * static_cast<double>(v.size() - 1));
+  std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(idx), v.end());
+  return v[idx];
+}
+
+/// <summary>
+/// Accept throughput: one connection at a time, connect, greeting, close.
+/// </summary>
+static int RunConnectOnly(const Options& opts)
+{
+  auto until = std::chrono::steady_clock::now() + std::chrono::seconds(opts.secs);
+  uint64_t done = 0;
+  uint64_t t0 = NowNs();
+  while (!g_stop && (opts.count ? done < opts.count : std::chrono::steady_clock::now() < until))
+  {
+    int fd = Connect(opts);
+    if (fd == -1)
+      return 1;
+
+    bool ok = ReadGreeting(fd);
+    close(fd);
+    if (!ok)
+    {
+      std::cerr << "No greeting\n";
+      return 1;
+    }
+    ++done;
+  }
+
+  double secs = static_cast<double>(NowNs() - t0) / 1e9;
+  printf("connects=%llu secs=%.2f connects/s=%.0f\n", static_cast<unsigned long long>(done), secs,
+    static_cast<double>(done) / secs);
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
+  Options opts;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    size_t v = 0;
+    if (arg == "--latency") { opts.latency = true; continue; }
+    if (arg == "--connect-only") { opts.connectOnly = true; continue; }
+    if (arg.rfind("--host=", 0) == 0) { opts.host = arg.substr(7); continue; }
+
+    size_t eq = arg.find('=');
+    std::string key = arg.substr(0, eq == std::string::npos ? arg.size() : eq + 1);
+    std::string val = eq == std::string::npos ? arg : arg.substr(eq + 1);
+    if (!ParseCount(val, v))
+      return BadOption(arg);
+
+    if (key == arg) opts.port = static_cast<int>(v);
+    else if (key == "--conns=") opts.conns = v;
+    else if (key == "--senders=") opts.senders = v;
+    else if (key == "--size=") opts.size = v;
+    else if (key == "--rate=") opts.rate = v;
+    else if (key == "--secs=") opts.secs = v;
+    else if (key == "--warmup=") opts.warmup = v;
+    else if (key == "--rcvbuf=") opts.rcvbuf = v;
+    else if (key == "--count=") opts.count = v;
+    else return BadOption(arg);
+  }
+
+  if (opts.size < HEADER + 1 || opts.senders > opts.conns || opts.port <= 0 || opts.port > 65535 ||
+    (opts.latency && opts.senders != 1))
+  {
+    std::cerr << "Need --size>" << HEADER << ", --senders<=--conns, and exactly one sender with --latency\n" << USAGE;
+    return 1;
+  }
+
+  std::signal(SIGINT, [](int) { g_stop = 1; });
+  std::signal(SIGPIPE, SIG_IGN);
+
+  if (opts.connectOnly)
+    return RunConnectOnly(opts);
+
+  int ep = epoll_create1(EPOLL_CLOEXEC);
+  if (ep == -1)
+  {
+    perror("epoll_create1");
+    return 1;
+  }
+
+  // Connect everybody and wait for the greetings, so the senders start into a full room
+  std::vector<Conn> conns(opts.conns);
+  for (size_t i = 0; i < conns.size(); ++i)
+  {
+    Conn& c = conns[i];
+    c.fd = Connect(opts);
+    if (c.fd == -1 || !ReadGreeting(c.fd))
+    {
+      std::cerr << "Connection " << i << " failed\n";
+      return 1;
+    }
+    fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL, 0) | O_NONBLOCK);
+
+    epoll_event ev{};
+    // Level-triggered, the per-event budgets leave data behind on purpose
+    bool flatOut = i < opts.senders && opts.rate == 0;
+    ev.events = EPOLLIN | (flatOut ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.u64 = i;
+    epoll_ctl(ep, EPOLL_CTL_ADD, c.fd, &ev);
+  }
+
+  std::vector<uint32_t> samples;
+  std::vector<epoll_event> events(1024);
+  uint64_t start = NowNs();
+  uint64_t open = start + opts.warmup * 1000000000ull;
+  uint64_t close_ = open + opts.secs * 1000000000ull;
+  uint64_t sentAtOpen = 0;
+  bool measuring = false;
+  bool failed = false;
+
+  while (!g_stop && !failed)
+  {
+    uint64_t now = NowNs();
+    if (!measuring && now >= open)
+    {
+      measuring = true;
+      for (size_t i = 0; i < opts.senders; ++i)
+        sentAtOpen += conns[i].sentMsgs;
+    }
+    if (now >= close_)
+      break;
+
+    // Paced senders get their due lines on every turn, the timeout keeps the pace
+    uint64_t due = opts.rate > 0 ? (now - start) * opts.rate / 1000000000ull + 1 : 0;
+    int timeout = 100;
+    if (opts.rate > 0)
+    {
+      for (size_t i = 0; i < opts.senders && !failed; ++i)
+        failed = !Pump(conns[i], opts, due);
+
+      uint64_t next = start + due * 1000000000ull / opts.rate;
+      timeout = next > now ? static_cast<int>((next - now) / 1000000) : 0;
+    }
+
+    int n = epoll_wait(ep, events.data(), static_cast<int>(events.size()), timeout);
+    if (n < 0)
+    {
+      if (errno == EINTR) continue;
+      perror("epoll_wait");
+      return 1;
+    }
+
+    for (int k = 0; k < n && !failed; ++k)
+    {
+      Conn& c = conns[events[k].data.u64];
+      if (events[k].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        failed = !Drain(c, measuring, opts.latency, samples);
+      if (!failed && (events[k].events & EPOLLOUT) && opts.rate == 0)
+        failed = !Pump(c, opts, 0);
+    }
+  }
+
+  if (failed)
+  {
+    std::cerr << "A connection failed during the run\n";
+    return 1;
+  }
+
+  double secs = static_cast<double>(NowNs() - open) / 1e9;
+  uint64_t sent = 0;
+  uint64_t rx = 0;
+  for (size_t i = 0; i < conns.size(); ++i)
+  {
+    if (i < opts.senders)
+      sent += conns[i].sentMsgs;
+    rx += conns[i].rxBytes;
+    close(conns[i].fd);
+  }
+  close(ep);
+
+  // Received bytes over the line size: the delivered messages, whatever the chunking
+  double sentRate = static_cast<double>(sent - sentAtOpen) / secs;
+  double delivered = static_cast<double>(rx) / static_cast<double>(opts.size) / secs;
+  printf("conns=%zu senders=%zu size=%zu secs=%.2f sent_msgs/s=%.0f delivered_msgs/s=%.0f delivered_MB/s=%.1f",
+    opts.conns, opts.senders, opts.size, secs, sentRate, delivered, static_cast<double>(rx) / secs / 1e6);
+  if (opts.latency)
+  {
+    printf(" samples=%zu p50_us=%.0f p99_us=%.0f max_us=%.0f", samples.size(),
+      Percentile(samples, 0.50), Percentile(samples, 0.99), Percentile(samples, 1.0));
+  }
+  printf("\n");
+  return 0;
+}
@@ -0,0 +1,243 @@
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include <linux/perf_event.h> // perf_event_attr
+#include <sys/ioctl.h>        // ioctl()
+#include <sys/syscall.h>      // SYS_perf_event_open
+#include <unistd.h>           // read(), close()
+
+#include "ClientSession.h"
+#include "SessionSlab.h"
+
+// Stand-in for MsgRef, one pointer, so the queues have the real size without linking the pool
+struct Ref
+{
+  void* buf;
+};
+
+/// <summary>
+/// ClientSession before the hot/cold split, same members in the same order.
+/// IsWantSend() read the deque, the re-arm flags sat in front of it.
+/// </summary>
+struct OldSession
+{
+  explicit OldSession(int fd) : m_socket(fd) {}
+
+  bool IsWantSend() const { return !m_sendQueue.empty(); }
+
+  uint32_t m_armedEvents = 0;
+  bool m_dirty = false;
+  bool m_sendInFlight = false;
+  bool m_closing = false;
+  int m_socket;
+  EventLoop* m_loop = nullptr;
+  bool m_inlineSend = true;
+  bool m_spliceRelay = false;
+  size_t m_recvClass = 0;
+  std::deque<Ref> m_sendQueue;
+  size_t m_sendOffset = 0;
+  std::unique_ptr<char[]> m_uringSend;
+  bool m_zeroCopy = false;
+  size_t m_zeroCopyMin = 0;
+  uint32_t m_zcNextId = 0;
+  std::deque<Ref> m_zcPending;
+};
+
+/// <summary>
+/// ClientSession as it is now: the server's own Hot line, then the out-of-line pointers.
+/// </summary>
+struct alignas(64) NewSession
+{
+  explicit NewSession(int fd) { m_hot.socket = fd; }
+
+  bool IsWantSend() const { return m_hot.queued != 0; }
+
+  ClientSession::Hot m_hot;
+  std::unique_ptr<std::deque<Ref>> m_sendQueue;
+  std::unique_ptr<char[]> m_uringSend;
+  std::unique_ptr<std::deque<Ref>> m_zcPending;
+  uint32_t m_zcNextId = 0;
+};
+
+static_assert(sizeof(NewSession) == sizeof(ClientSession), "NewSession must mirror ClientSession");
+
+static constexpr size_t BROADCASTS = 200;
+// Bigger than any LLC here, walked between broadcasts so each one starts cold
+static constexpr size_t EVICT_BYTES = 64 << 20;
+
+static volatile uint64_t g_sink;
+
+/// <summary>
+/// User-space L1D and LLC read-miss counters for this thread, -1 where the PMU is not exposed.
+/// </summary>
+class MissCounters
+{
+public:
+  MissCounters()
+  {
+    m_l1 = Open(PERF_COUNT_HW_CACHE_L1D);
+    m_llc = Open(PERF_COUNT_HW_CACHE_LL);
+  }
+
+  ~MissCounters()
+  {
+    if (m_l1 != -1) close(m_l1);
+    if (m_llc != -1) close(m_llc);
+  }
+
+  bool Available() const { return m_l1 != -1 && m_llc != -1; }
+
+  void Start()
+  {
+    for (int fd : { m_l1, m_llc })
+    {
+      if (fd != -1)
+      {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  void Stop(uint64_t& l1, uint64_t& llc)
+  {
+    l1 += Read(m_l1);
+    llc += Read(m_llc);
+  }
+
+private:
+  static int Open(uint64_t cache)
+  {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  static uint64_t Read(int fd)
+  {
+    uint64_t v = 0;
+    if (fd == -1)
+      return 0;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &v, sizeof(v)) != sizeof(v))
+      return 0;
+    return v;
+  }
+
+  int m_l1 = -1;
+  int m_llc = -1;
+};
+
+/// <summary>
+/// One broadcast's per-recipient checks, as the epoll loop makes them for a
+/// recipient whose queue is backed up: closing, inline-send and want-send
+/// state, then the deferred re-arm marks the session dirty.
+/// </summary>
+static uint64_t Visit(OldSession* s)
+{
+  uint64_t v = s->m_closing + s->m_inlineSend + s->IsWantSend();
+  if (!s->m_dirty)
+  {
+    s->m_dirty = true;
+    v += s->m_armedEvents + static_cast<uint64_t>(s->m_socket);
+  }
+  return v;
+}
+
+static uint64_t Visit(NewSession* s)
+{
+  uint64_t v = s->m_hot.closing + s->m_hot.inlineSend + s->IsWantSend();
+  if (!s->m_hot.dirty)
+  {
+    s->m_hot.dirty = true;
+    v += s->m_hot.armedEvents + static_cast<uint64_t>(s->m_hot.socket);
+  }
+  return v;
+}
+
+static void ClearDirty(OldSession* s) { s->m_dirty = false; }
+static void ClearDirty(NewSession* s) { s->m_hot.dirty = false; }
+
+template <typename T>
+static void Run(const char* name, size_t n, const std::vector<int>& fds, bool cold, MissCounters& pmu)
+{
+  SessionSlab<T> slab;
+  for (int fd : fds)
+    slab.Emplace(fd, fd);
+
+  std::vector<unsigned char> evict(cold ? EVICT_BYTES : 0);
+  uint64_t sink = 0;
+  uint64_t l1 = 0;
+  uint64_t llc = 0;
+  double ns = 0;
+  for (size_t b = 0; b < BROADCASTS; ++b)
+  {
+    // Untimed: the re-arm pass of the previous iteration, then whatever else the loop did
+    for (T* s : slab.Live())
+      ClearDirty(s);
+    for (size_t i = 0; i < evict.size(); i += 64)
+      sink += ++evict[i];
+
+    pmu.Start();
+    auto t0 = std::chrono::steady_clock::now();
+    for (T* s : slab.Live())
+      sink += Visit(s);
+    auto t1 = std::chrono::steady_clock::now();
+    pmu.Stop(l1, llc);
+    ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+  }
+
+  g_sink = sink;
+  printf("%6s %8zu %5s %6zu %12.1f", name, n, cold ? "cold" : "warm", sizeof(T), ns / BROADCASTS / 1000.0);
+  if (pmu.Available())
+    printf(" %12.0f %12.0f\n", static_cast<double>(l1) / BROADCASTS, static_cast<double>(llc) / BROADCASTS);
+  else
+    printf(" %12s %12s\n", "n/a", "n/a");
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<size_t> sizes = { 50000 };
+  if (argc > 1)
+  {
+    sizes.clear();
+    for (int i = 1; i < argc; ++i)
+      sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+  }
+
+  MissCounters pmu;
+  printf("per broadcast to every session, ClientSession layout before and after the hot/cold split\n");
+  if (!pmu.Available())
+    printf("no hardware cache counters here, miss columns are n/a\n");
+  printf("%6s %8s %5s %6s %12s %12s %12s\n", "layout", "sessions", "cache", "bytes", "us/bcast", "L1D misses",
+    "LLC misses");
+  for (size_t n : sizes)
+  {
+    std::mt19937 rng(42);
+    std::vector<int> fds(n);
+    for (size_t i = 0; i < n; ++i)
+      fds[i] = static_cast<int>(i) + 8;
+    std::shuffle(fds.begin(), fds.end(), rng);
+
+    for (bool cold : { false, true })
+    {
+      Run<OldSession>("old", n, fds, cold, pmu);
+      Run<NewSession>("new", n, fds, cold, pmu);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,167 @@
+#include <vector>
+#include <deque>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include <climits>      // IOV_MAX
+#include <sys/uio.h>    // iovec
+
+#include "ByteRing.h"
+
+static constexpr size_t SEND_IOV_MAX = IOV_MAX;
+// What one sendmsg() moves before the socket buffer is full
+static constexpr size_t KERNEL_TAKE = 64 * 1024;
+static constexpr size_t MIN_BYTES = 512u << 20;
+
+static volatile uint64_t g_sink;
+static char g_kernel[KERNEL_TAKE];
+
+/// <summary>
+/// Stands in for sendmsg(): copies up to KERNEL_TAKE bytes out of iov, returns how many.
+/// </summary>
+static size_t FakeSendmsg(const iovec* iov, size_t cnt)
+{
+  size_t off = 0;
+  for (size_t i = 0; i < cnt && off < KERNEL_TAKE; ++i)
+  {
+    size_t len = iov[i].iov_len;
+    if (len > KERNEL_TAKE - off) len = KERNEL_TAKE - off;
+    memcpy(g_kernel + off, iov[i].iov_base, len);
+    off += len;
+  }
+  return off;
+}
+
+/// <summary>
+/// The poll server's send queue before the byte ring: a string per message, an
+/// offset into the front one, gathered up to IOV_MAX messages per sendmsg().
+/// </summary>
+class DequeQueue
+{
+public:
+  void Append(const std::string& msg)
+  {
+    m_queue.push_back(msg);
+  }
+
+  void Flush()
+  {
+    iovec iov[SEND_IOV_MAX];
+    while (!m_queue.empty())
+    {
+      size_t cnt = 0;
+      for (auto it = m_queue.begin(); it != m_queue.end() && cnt < SEND_IOV_MAX; ++it, ++cnt)
+      {
+        size_t offset = (cnt == 0) ? m_offset : 0;
+        iov[cnt].iov_base = const_cast<char*>(it->data() + offset);
+        iov[cnt].iov_len = it->size() - offset;
+      }
+      Consume(FakeSendmsg(iov, cnt));
+    }
+  }
+
+private:
+  void Consume(size_t bytes)
+  {
+    while (bytes > 0 && !m_queue.empty())
+    {
+      size_t left = m_queue.front().size() - m_offset;
+      if (bytes < left)
+      {
+        m_offset += bytes;
+        return;
+      }
+      bytes -= left;
+      m_queue.pop_front();
+      m_offset = 0;
+    }
+  }
+
+  std::deque<std::string> m_queue;
+  size_t m_offset = 0;
+};
+
+/// <summary>
+/// The poll server's send queue now: the ring, flushed with at most two iovecs.
+/// </summary>
+class RingQueue
+{
+public:
+  void Append(const std::string& msg)
+  {
+    m_ring.Append(msg.data(), msg.size());
+  }
+
+  void Flush()
+  {
+    iovec iov[2];
+    while (!m_ring.Empty())
+    {
+      size_t cnt = m_ring.Peek(iov);
+      m_ring.Consume(FakeSendmsg(iov, cnt));
+    }
+  }
+
+private:
+  ByteRing m_ring;
+};
+
+/// <summary>
+/// Rounds of depth appends then one flush, until MIN_BYTES went through. ns per message.
+/// </summary>
+template <typename Q>
+static void Run(size_t size, size_t depth, double& appendNs, double& flushNs)
+{
+  std::string msg(size, 'x');
+  msg.back() = '\n';
+  size_t rounds = MIN_BYTES / (size * depth) + 1;
+
+  Q q;
+  double append = 0;
+  double flush = 0;
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < depth; ++i)
+      q.Append(msg);
+    auto t1 = std::chrono::steady_clock::now();
+    q.Flush();
+    auto t2 = std::chrono::steady_clock::now();
+    append += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    flush += std::chrono::duration<double, std::nano>(t2 - t1).count();
+  }
+
+  g_sink = static_cast<uint64_t>(g_kernel[0]);
+  appendNs = append / static_cast<double>(rounds * depth);
+  flushNs = flush / static_cast<double>(rounds * depth);
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<size_t> sizes = { 64, 1024, 16384 };
+  if (argc > 1)
+  {
+    sizes.clear();
+    for (int i = 1; i < argc; ++i)
+      sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+  }
+
+  printf("ns per message, deque<string> vs ByteRing, sendmsg() replaced by a %zu KB copy\n", KERNEL_TAKE / 1024);
+  printf("%6s %6s %14s %14s %14s %14s\n", "bytes", "depth", "deque append", "ring append", "deque flush",
+    "ring flush");
+  for (size_t size : sizes)
+  {
+    for (size_t depth : { 1, 16, 256 })
+    {
+      double dequeAppend, dequeFlush, ringAppend, ringFlush;
+      Run<DequeQueue>(size, depth, dequeAppend, dequeFlush);
+      Run<RingQueue>(size, depth, ringAppend, ringFlush);
+      printf("%6zu %6zu %14.1f %14.1f %14.1f %14.1f\n", size, depth, dequeAppend, ringAppend, dequeFlush, ringFlush);
+    }
+  }
+  return 0;
+}
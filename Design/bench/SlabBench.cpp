@@ -0,0 +1,120 @@
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "SessionSlab.h"
+
+/// <summary>
+/// Stand-in for ClientSession: two cache lines, a field the fan-out touches.
+/// </summary>
+struct alignas(64) FakeSession
+{
+  explicit FakeSession(int fd) : socket(fd) {}
+
+  int socket;
+  uint32_t queued = 0;
+  unsigned char cold[120];
+};
+
+static constexpr size_t LOOKUPS = 4000000;
+static constexpr size_t MIN_BROADCAST_VISITS = 20000000;
+
+// Keeps the timed loops from being optimised away
+static volatile uint64_t g_sink;
+
+template <typename F>
+static double NsPer(size_t ops, F&& body)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  body();
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(ops);
+}
+
+/// <summary>
+/// fds as the kernel hands them out after some churn: dense from a base, in random order.
+/// </summary>
+static std::vector<int> MakeFds(size_t n, std::mt19937& rng)
+{
+  std::vector<int> fds(n);
+  for (size_t i = 0; i < n; ++i)
+    fds[i] = static_cast<int>(i) + 8;
+  std::shuffle(fds.begin(), fds.end(), rng);
+  return fds;
+}
+
+static void Run(size_t n)
+{
+  std::mt19937 rng(42);
+  std::vector<int> fds = MakeFds(n, rng);
+
+  // Event order: random live fds, as epoll reports them
+  std::vector<int> probes(LOOKUPS);
+  for (auto& p : probes)
+    p = fds[rng() % n];
+
+  std::unordered_map<int, std::unique_ptr<FakeSession>> map;
+  SessionSlab<FakeSession> slab;
+  for (int fd : fds)
+  {
+    map.emplace(fd, std::make_unique<FakeSession>(fd));
+    slab.Emplace(fd, fd);
+  }
+
+  uint64_t sink = 0;
+  double mapLookup = NsPer(LOOKUPS, [&]
+  {
+    for (int fd : probes)
+      sink += ++map.find(fd)->second->queued;
+  });
+
+  double slabLookup = NsPer(LOOKUPS, [&]
+  {
+    for (int fd : probes)
+      sink += ++slab.Get(fd, 1)->queued;
+  });
+
+  // Fan-out: visit every session and queue onto it
+  size_t rounds = std::max<size_t>(1, MIN_BROADCAST_VISITS / n);
+  double mapBroadcast = NsPer(rounds * n, [&]
+  {
+    for (size_t r = 0; r < rounds; ++r)
+      for (auto& kv : map)
+        sink += ++kv.second->queued;
+  });
+
+  double slabBroadcast = NsPer(rounds * n, [&]
+  {
+    for (size_t r = 0; r < rounds; ++r)
+      for (FakeSession* s : slab.Live())
+        sink += ++s->queued;
+  });
+
+  g_sink = sink;
+  printf("%8zu %12.1f %12.1f %14.2f %15.2f\n", n, mapLookup, slabLookup, mapBroadcast, slabBroadcast);
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<size_t> sizes = { 1000, 10000, 100000 };
+  if (argc > 1)
+  {
+    sizes.clear();
+    for (int i = 1; i < argc; ++i)
+      sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+  }
+
+  printf("ns per op, unordered_map<int, unique_ptr> vs SessionSlab\n");
+  printf("%8s %12s %12s %14s %14s\n", "sessions", "map lookup", "slab lookup", "map bcast/sess", "slab bcast/sess");
+  for (size_t n : sizes)
+  {
+    Run(n);
+  }
+  return 0;
+}
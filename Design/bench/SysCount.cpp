@@ -0,0 +1,205 @@
+// LD_PRELOAD shim counting heap allocations and the I/O syscalls the servers make.
+// Counters live in a shared file mapping named by SYSCOUNT_FILE, so a bench script
+// reads them while the server runs, no signal or exit hook needed.
+//
+//   SYSCOUNT_FILE=/tmp/counts LD_PRELOAD=libSysCount.so Server ...
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <dlfcn.h>       // dlsym()
+#include <fcntl.h>       // open()
+#include <sys/mman.h>    // mmap()
+#include <sys/socket.h>  // send(), sendmsg(), recv(), recvmsg()
+#include <sys/epoll.h>   // epoll_ctl(), epoll_wait()
+#include <sys/syscall.h> // __NR_io_uring_enter
+#include <unistd.h>      // read(), write(), ftruncate()
+
+/// <summary>
+/// Counter slots in the mapping. chatbench.SYSCOUNT_NAMES lists them in the same order.
+/// </summary>
+enum Counter
+{
+  Mallocs, Frees, Send, SendMsg, Recv, RecvMsg, EpollCtl, EpollWait, Splice, Tee, UringEnter,
+  Write, Read, COUNTER_NUM
+};
+
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void __libc_free(void* p);
+}
+
+static std::atomic<uint64_t>* g_counters = nullptr;
+
+static inline void Bump(Counter c)
+{
+  if (g_counters)
+    g_counters[c].fetch_add(1, std::memory_order_relaxed);
+}
+
+__attribute__((constructor)) static void MapCounters()
+{
+  const char* path = getenv("SYSCOUNT_FILE");
+  if (path == nullptr)
+    return;
+
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    return;
+
+  size_t len = COUNTER_NUM * sizeof(uint64_t);
+  if (ftruncate(fd, static_cast<off_t>(len)) == 0)
+  {
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p != MAP_FAILED)
+      g_counters = static_cast<std::atomic<uint64_t>*>(p);
+  }
+  close(fd);
+}
+
+template <typename F>
+static F Next(const char* name)
+{
+  return reinterpret_cast<F>(dlsym(RTLD_NEXT, name));
+}
+
+//
+// === Allocator ===
+//
+
+extern "C" void* malloc(size_t size)
+{
+  Bump(Mallocs);
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t n, size_t size)
+{
+  Bump(Mallocs);
+  return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* p, size_t size)
+{
+  if (p == nullptr)
+    Bump(Mallocs);
+  return __libc_realloc(p, size);
+}
+
+extern "C" void free(void* p)
+{
+  if (p != nullptr)
+    Bump(Frees);
+  __libc_free(p);
+}
+
+extern "C" int posix_memalign(void** out, size_t align, size_t size)
+{
+  static auto next = Next<int (*)(void**, size_t, size_t)>("posix_memalign");
+  Bump(Mallocs);
+  return next(out, align, size);
+}
+
+extern "C" void* aligned_alloc(size_t align, size_t size)
+{
+  static auto next = Next<void* (*)(size_t, size_t)>("aligned_alloc");
+  Bump(Mallocs);
+  return next(align, size);
+}
+
+//
+// === Syscalls ===
+//
+
+extern "C" ssize_t send(int fd, const void* buf, size_t len, int flags)
+{
+  static auto next = Next<ssize_t (*)(int, const void*, size_t, int)>("send");
+  Bump(Send);
+  return next(fd, buf, len, flags);
+}
+
+extern "C" ssize_t sendmsg(int fd, const msghdr* msg, int flags)
+{
+  static auto next = Next<ssize_t (*)(int, const msghdr*, int)>("sendmsg");
+  Bump(SendMsg);
+  return next(fd, msg, flags);
+}
+
+extern "C" ssize_t recv(int fd, void* buf, size_t len, int flags)
+{
+  static auto next = Next<ssize_t (*)(int, void*, size_t, int)>("recv");
+  Bump(Recv);
+  return next(fd, buf, len, flags);
+}
+
+extern "C" ssize_t recvmsg(int fd, msghdr* msg, int flags)
+{
+  static auto next = Next<ssize_t (*)(int, msghdr*, int)>("recvmsg");
+  Bump(RecvMsg);
+  return next(fd, msg, flags);
+}
+
+extern "C" int epoll_ctl(int ep, int op, int fd, epoll_event* ev)
+{
+  static auto next = Next<int (*)(int, int, int, epoll_event*)>("epoll_ctl");
+  Bump(EpollCtl);
+  return next(ep, op, fd, ev);
+}
+
+extern "C" int epoll_wait(int ep, epoll_event* events, int max, int timeout)
+{
+  static auto next = Next<int (*)(int, epoll_event*, int, int)>("epoll_wait");
+  Bump(EpollWait);
+  return next(ep, events, max, timeout);
+}
+
+extern "C" ssize_t splice(int in, loff_t* offIn, int out, loff_t* offOut, size_t len, unsigned flags)
+{
+  static auto next = Next<ssize_t (*)(int, loff_t*, int, loff_t*, size_t, unsigned)>("splice");
+  Bump(Splice);
+  return next(in, offIn, out, offOut, len, flags);
+}
+
+extern "C" ssize_t tee(int in, int out, size_t len, unsigned flags)
+{
+  static auto next = Next<ssize_t (*)(int, int, size_t, unsigned)>("tee");
+  Bump(Tee);
+  return next(in, out, len, flags);
+}
+
+extern "C" ssize_t write(int fd, const void* buf, size_t len)
+{
+  static auto next = Next<ssize_t (*)(int, const void*, size_t)>("write");
+  Bump(Write);
+  return next(fd, buf, len);
+}
+
+extern "C" ssize_t read(int fd, void* buf, size_t len)
+{
+  static auto next = Next<ssize_t (*)(int, void*, size_t)>("read");
+  Bump(Read);
+  return next(fd, buf, len);
+}
+
+// io_uring has no libc wrapper, the servers go through syscall()
+extern "C" long syscall(long number, ...)
+{
+  static auto next = Next<long (*)(long, ...)>("syscall");
+
+  va_list ap;
+  va_start(ap, number);
+  long a[6];
+  for (auto& v : a)
+    v = va_arg(ap, long);
+  va_end(ap);
+
+  if (number == __NR_io_uring_enter)
+    Bump(UringEnter);
+  return next(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
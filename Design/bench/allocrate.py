@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+user-013: the server's allocation rate in steady state.
+
+Runs the server under libSysCount.so while --senders of --conns clients
+publish --size byte lines at --rate lines/s each, and samples the malloc
+counter across the middle of the run. Reports mallocs/s and mallocs per
+recv() the server made, for the server and for --baseline.
+"""
+import time
+
+import chatbench
+
+
+def measure(a, server, args):
+    with chatbench.Server(server, a.port, args, syscount=a.syscount) as srv:
+        load = chatbench.start_load(a.load, a.port, conns=a.conns, senders=a.senders, size=a.size,
+                                    rate=a.rate, warmup=a.warmup, secs=a.secs)
+        time.sleep(a.warmup + 0.5)
+        c0 = srv.counters()
+        time.sleep(a.secs - 1)
+        d = chatbench.delta(srv.counters(), c0)
+        r = chatbench.finish_load(load)
+
+    window = a.secs - 1
+    recvs = d["recv"] + d["recvmsg"] + d["read"]
+    return float(r["delivered_msgs/s"]), d["mallocs"] / window, d["mallocs"] / max(1, recvs)
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--baseline", help="server binary to compare against")
+    p.add_argument("--conns", type=int, default=100)
+    p.add_argument("--senders", type=int, default=10)
+    p.add_argument("--size", type=int, default=256)
+    p.add_argument("--rate", type=int, default=500, help="lines/s per sender")
+    p.add_argument("--warmup", type=int, default=2)
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    servers = [("current", a.server, a.server_args.split())]
+    if a.baseline:
+        servers.append(("baseline", a.baseline, []))
+
+    print("%10s %16s %12s %12s" % ("server", "delivered msgs/s", "mallocs/s", "mallocs/recv"))
+    for name, server, args in servers:
+        delivered, rate, per = measure(a, server, args)
+        print("%10s %16.0f %12.0f %12.2f" % (name, delivered, rate, per))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+user-005: heap allocations per broadcast as the room grows.
+
+Runs the server under libSysCount.so. One sender publishes --size byte lines
+at --rate to the other clients; the malloc counter is sampled across the
+middle of the run, after every client has connected, and divided by the lines
+sent in that window. Per-connection setup is outside the window, so what is
+left is the cost of receiving and fanning out a line. --baseline runs the
+same load against a server built from an older revision.
+"""
+import time
+
+import chatbench
+
+
+def measure(a, server, args, recipients):
+    with chatbench.Server(server, a.port, args, syscount=a.syscount) as srv:
+        load = chatbench.start_load(a.load, a.port, conns=recipients + 1, senders=1, size=a.size,
+                                    rate=a.rate, warmup=a.warmup, secs=a.secs)
+        time.sleep(a.warmup + 0.5)
+        c0 = srv.counters()
+        time.sleep(a.secs - 1)
+        c1 = srv.counters()
+        r = chatbench.finish_load(load)
+    d = chatbench.delta(c1, c0)
+    sent = float(r["sent_msgs/s"]) * (a.secs - 1)
+    delivered = float(r["delivered_msgs/s"]) * (a.secs - 1)
+    return d["mallocs"] / sent, delivered / sent
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--baseline", help="server binary to compare against")
+    p.add_argument("--recipients", default="10,100,1000", help="comma separated room sizes")
+    p.add_argument("--size", type=int, default=1024)
+    p.add_argument("--rate", type=int, default=100)
+    p.add_argument("--warmup", type=int, default=2)
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    servers = [("current", a.server, a.server_args.split())]
+    if a.baseline:
+        servers.append(("baseline", a.baseline, []))
+    print("%10s %10s %18s %18s" % ("server", "recipients", "mallocs/broadcast", "deliveries/line"))
+    for name, server, args in servers:
+        for n in [int(x) for x in a.recipients.split(",")]:
+            allocs, fanout = measure(a, server, args, n)
+            print("%10s %10d %18.1f %18.0f" % (name, n, allocs, fanout))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+"""
+user-009: epoll loop against the io_uring proactor, side by side.
+
+For each --backend it measures connect/greeting/close cycles per second with
+ChatLoad --connect-only, then delivered msgs/s with --senders of --conns
+clients publishing --size byte lines flat out, and the server CPU time per
+delivered message.
+"""
+import chatbench
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--backends", default="epoll,uring")
+    p.add_argument("--conns", type=int, default=100)
+    p.add_argument("--senders", type=int, default=10)
+    p.add_argument("--size", type=int, default=64)
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    print("%8s %12s %16s %12s %10s" % ("backend", "connects/s", "delivered msgs/s", "cpu ns/msg", "server cpu"))
+    for backend in a.backends.split(","):
+        args = a.server_args.split() + ["--backend=" + backend]
+        with chatbench.Server(a.server, a.port, args):
+            c = chatbench.run_load(a.load, a.port, connect_only=True, secs=a.secs)
+
+        with chatbench.Server(a.server, a.port, args) as srv:
+            cpu0 = srv.cpu()
+            r = chatbench.run_load(a.load, a.port, conns=a.conns, senders=a.senders, size=a.size,
+                                   warmup=1, secs=a.secs)
+            cpu = srv.cpu() - cpu0
+
+        delivered = float(r["delivered_msgs/s"])
+        secs = a.secs + 1
+        print("%8s %12s %16.0f %12.1f %9.0f%%" % (backend, c["connects/s"], delivered,
+                                                  cpu / (delivered * secs) * 1e9, cpu / secs * 100))
+
+
+if __name__ == "__main__":
+    main()
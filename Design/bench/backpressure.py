@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+user-019: backpressure bounds memory without dropping anything.
+
+A publisher floods --mb MB in 64 KB chunks to --receivers clients that each
+read 64 KB every 2 ms (~32 MB/s). With --backpressure the server pauses the
+publisher's reads instead of queueing or dropping, so every receiver must
+get every byte while the server's RSS stays near the budget. Runs each
+--loops count with the budget, and once with unbounded queues
+(--tx-hwm=0) for comparison. Reports MB each receiver got, whether all of
+it arrived, peak RSS, and the pause and drop counters from --stats.
+"""
+import socket
+import threading
+import time
+
+import chatbench
+
+CHUNK = 65536
+GREETING = len(b"Welcome to the chat!\n")
+
+
+def run(a, args):
+    total = a.mb << 20
+    with chatbench.Server(a.server, a.port, args + ["--stats=1"]) as srv:
+        receivers = [socket.create_connection(("127.0.0.1", a.port)) for _ in range(a.receivers)]
+        pub = socket.create_connection(("127.0.0.1", a.port))
+        time.sleep(0.3)
+        pub.recv(100)
+        got = [0] * a.receivers
+
+        def read(i):
+            while got[i] < total + GREETING:
+                d = receivers[i].recv(CHUNK)
+                if not d:
+                    break
+                got[i] += len(d)
+                time.sleep(0.002)
+
+        def publish():
+            chunk = b"z" * CHUNK
+            for _ in range(total // CHUNK):
+                pub.sendall(chunk)
+
+        threads = [threading.Thread(target=read, args=(i,)) for i in range(a.receivers)]
+        threads.append(threading.Thread(target=publish))
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        time.sleep(1.1)  # one more stats line
+        peak = srv.peak_rss_kb()
+        stats = srv.stats()
+        for s in receivers + [pub]:
+            s.close()
+
+    last = stats[-1] if stats else {}
+    pauses = int(last.get("pauses", 0))
+    drops = sum(int(v) for k, v in last.items() if k.endswith(("dropped newest", "oldest", "disconnects")))
+    mb = [(g - GREETING) >> 20 for g in got]
+    return mb, all(g == total + GREETING for g in got), peak, pauses, drops
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--mb", type=int, default=200, help="MB the publisher floods")
+    p.add_argument("--receivers", type=int, default=2)
+    p.add_argument("--budget", type=int, default=2 << 20, help="--backpressure bytes")
+    p.add_argument("--loops", default="1,2", help="comma separated loop counts")
+    a = p.parse_args()
+
+    extra = a.server_args.split()
+    runs = [("budget, loops=%s" % loops, extra + ["--backpressure=%d" % a.budget, "--loops=" + loops])
+            for loops in a.loops.split(",")]
+    runs.append(("unbounded", extra + ["--tx-hwm=0"]))
+
+    print("%-20s %14s %9s %13s %8s %7s" % ("config", "MB received", "complete", "peak rss KB", "pauses", "drops"))
+    for name, args in runs:
+        mb, complete, peak, pauses, drops = run(a, args)
+        print("%-20s %14s %9s %13d %8d %7d" % (name, ",".join(map(str, mb)), complete, peak, pauses, drops))
+
+
+if __name__ == "__main__":
+    main()
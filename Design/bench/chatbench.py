@@ -0,0 +1,187 @@
+"""
+Shared plumbing for the bench scripts: default binary paths, a server launched
+under test with its CPU time and RSS read from /proc, ChatLoad runs parsed into
+dicts, and the server's --stats lines parsed into dicts.
+"""
+import argparse
+import os
+import re
+import shutil
+import signal
+import socket
+import struct
+import subprocess
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+DEFAULT_SERVER = os.path.join(ROOT, "Design", "event_loop", "build", "Server", "Server")
+DEFAULT_LOAD = os.path.join(ROOT, "Design", "bench", "build", "ChatLoad")
+DEFAULT_SYSCOUNT = os.path.join(ROOT, "Design", "bench", "build", "libSysCount.so")
+
+# Counter slots of SysCount.cpp, same order
+SYSCOUNT_NAMES = ["mallocs", "frees", "send", "sendmsg", "recv", "recvmsg", "epoll_ctl", "epoll_wait",
+                  "splice", "tee", "io_uring_enter", "write", "read"]
+CLK_TCK = os.sysconf("SC_CLK_TCK")
+
+
+def parser(description, server=DEFAULT_SERVER):
+    p = argparse.ArgumentParser(description=description)
+    p.add_argument("--server", default=server, help="server binary under test")
+    p.add_argument("--server-args", default="", help="extra options for --server, space separated")
+    p.add_argument("--load", default=DEFAULT_LOAD, help="ChatLoad binary")
+    p.add_argument("--port", type=int, default=27015)
+    p.add_argument("--syscount", default=DEFAULT_SYSCOUNT, help="libSysCount.so for counted runs")
+    return p
+
+
+def cpu_seconds(pid):
+    """User and system CPU seconds the process has used so far."""
+    with open("/proc/%d/stat" % pid) as f:
+        fields = f.read().rsplit(")", 1)[1].split()
+    return int(fields[11]) / CLK_TCK, int(fields[12]) / CLK_TCK
+
+
+def status_kb(pid, key):
+    """A VmRSS/VmHWM style field of /proc/<pid>/status, in KB."""
+    with open("/proc/%d/status" % pid) as f:
+        for line in f:
+            if line.startswith(key + ":"):
+                return int(line.split()[1])
+    return 0
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    s = sorted(values)
+    return s[min(len(s) - 1, int(p * (len(s) - 1)))]
+
+
+class Server:
+    """
+    A chat server under test. Output goes to a temp file. With --stats it is
+    line buffered when stdbuf is around, so the stats can be read while it
+    runs. Otherwise it stays block buffered, the per-message log would cost a
+    write() per line.
+    """
+
+    def __init__(self, binary, port, args=(), env=None, syscount=None):
+        self.port = port
+        self.log = tempfile.NamedTemporaryFile(prefix="chatbench-", suffix=".log", delete=False)
+        cmd = [binary, str(port)] + list(args)
+        if any(a.startswith("--stats") for a in args) and shutil.which("stdbuf"):
+            cmd = ["stdbuf", "-oL"] + cmd
+        full_env = dict(os.environ)
+        full_env.update(env or {})
+
+        # Counted run: the shim maps its counters into this file
+        self.counts = None
+        if syscount:
+            self.counts = tempfile.NamedTemporaryFile(prefix="chatbench-", suffix=".cnt", delete=False).name
+            full_env["LD_PRELOAD"] = os.path.abspath(syscount)
+            full_env["SYSCOUNT_FILE"] = self.counts
+        self.proc = subprocess.Popen(cmd, stdout=self.log, stderr=subprocess.STDOUT, env=full_env)
+        self.pid = self.proc.pid
+        self._wait_listening()
+
+    def _wait_listening(self):
+        deadline = time.time() + 5
+        while time.time() < deadline:
+            if self.proc.poll() is not None:
+                raise RuntimeError("server exited: " + self.output())
+            try:
+                socket.create_connection(("127.0.0.1", self.port), timeout=0.2).close()
+                time.sleep(0.1)  # let that probe connection be torn down
+                return
+            except OSError:
+                time.sleep(0.05)
+        raise RuntimeError("server did not start listening")
+
+    def cpu(self):
+        u, s = cpu_seconds(self.pid)
+        return u + s
+
+    def rss_kb(self):
+        return status_kb(self.pid, "VmRSS")
+
+    def peak_rss_kb(self):
+        return status_kb(self.pid, "VmHWM")
+
+    def counters(self):
+        """SysCount totals so far, empty if the run is not counted."""
+        if not self.counts:
+            return {}
+        with open(self.counts, "rb") as f:
+            data = f.read(8 * len(SYSCOUNT_NAMES))
+        if len(data) < 8 * len(SYSCOUNT_NAMES):
+            return {}
+        return dict(zip(SYSCOUNT_NAMES, struct.unpack("<%dQ" % len(SYSCOUNT_NAMES), data)))
+
+    def alive(self):
+        return self.proc.poll() is None
+
+    def output(self):
+        with open(self.log.name, errors="replace") as f:
+            return f.read()
+
+    def stats(self):
+        """Every [stats] line so far, as dicts of the numbers after each 'name:'."""
+        # Streamed, the per-message log of a long flood can outgrow memory
+        with open(self.log.name, errors="replace") as f:
+            return [parse_stats(l) for l in f if l.startswith("[stats]")]
+
+    def stop(self):
+        if self.proc.poll() is None:
+            self.proc.send_signal(signal.SIGINT)
+            try:
+                self.proc.wait(3)
+            except subprocess.TimeoutExpired:
+                self.proc.kill()
+                self.proc.wait()
+        os.unlink(self.log.name)
+        if self.counts:
+            os.unlink(self.counts)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.stop()
+
+
+def delta(after, before):
+    return {k: after[k] - before.get(k, 0) for k in after}
+
+
+def parse_stats(line):
+    out = {}
+    for m in re.finditer(r"([a-zA-Z_/ ]+?):\s*([0-9.]+)", line[len("[stats]"):]):
+        out[m.group(1).strip()] = float(m.group(2))
+    return out
+
+
+def load_cmd(load, port, **opts):
+    cmd = [load, str(port)]
+    for k, v in opts.items():
+        k = "--" + k.replace("_", "-")
+        cmd.append(k if v is True else "%s=%s" % (k, v))
+    return cmd
+
+
+def start_load(load, port, **opts):
+    """ChatLoad in the background, for sampling the server while it runs. See finish_load."""
+    return subprocess.Popen(load_cmd(load, port, **opts), stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            text=True)
+
+
+def finish_load(proc, timeout=None):
+    out, err = proc.communicate(timeout=timeout)
+    if proc.returncode != 0:
+        raise RuntimeError("ChatLoad failed: " + err)
+    return dict(kv.split("=", 1) for kv in out.split())
+
+
+def run_load(load, port, timeout=None, **opts):
+    """Runs ChatLoad with --key=value options and returns its key=value summary."""
+    return finish_load(start_load(load, port, **opts), timeout)
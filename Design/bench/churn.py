@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""
+user-014: accept throughput during a connection churn.
+
+ChatLoad --connect-only runs --count connect/greeting/close cycles back to
+back, so every session slot is freed and taken again. Reports connects/s,
+server CPU and mallocs per accept, and the server's peak RSS, for the
+server with --prewarm=0 and --prewarm=N and for --baseline, a tree without
+the session pool. --poll and --poll-baseline add the same runs for the
+poll server.
+"""
+import chatbench
+
+
+def measure(a, server, args):
+    with chatbench.Server(server, a.port, args, syscount=a.syscount) as srv:
+        c0 = srv.counters()
+        cpu0 = srv.cpu()
+        r = chatbench.run_load(a.load, a.port, connect_only=True, count=a.count)
+        cpu = srv.cpu() - cpu0
+        d = chatbench.delta(srv.counters(), c0)
+        peak = srv.peak_rss_kb()
+
+    n = int(r["connects"])
+    return float(r["connects/s"]), cpu * 1e6 / n, d["mallocs"] / n, peak
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--baseline", help="epoll server binary without the session pool")
+    p.add_argument("--poll", help="poll server binary")
+    p.add_argument("--poll-baseline", help="poll server binary without the session pool")
+    p.add_argument("--count", type=int, default=50000, help="connect/close cycles per run")
+    p.add_argument("--prewarm", type=int, default=1024, help="slots prewarmed in the second run")
+    a = p.parse_args()
+
+    extra = a.server_args.split()
+    runs = [("prewarm=0", a.server, extra + ["--prewarm=0"]),
+            ("prewarm=%d" % a.prewarm, a.server, extra + ["--prewarm=%d" % a.prewarm])]
+    if a.baseline:
+        runs.append(("baseline", a.baseline, []))
+    if a.poll:
+        runs.append(("poll", a.poll, []))
+    if a.poll_baseline:
+        runs.append(("poll base", a.poll_baseline, []))
+
+    print("%14s %11s %14s %15s %14s" % ("server", "connects/s", "cpu us/accept", "mallocs/accept",
+                                        "peak rss KB"))
+    for name, server, args in runs:
+        rate, cpu, mallocs, peak = measure(a, server, args)
+        print("%14s %11.0f %14.1f %15.2f %14d" % (name, rate, cpu, mallocs, peak))
+
+
+if __name__ == "__main__":
+    main()
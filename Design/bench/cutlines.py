@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+user-008: no line may arrive cut when a send queue overflows.
+
+A reader with a 4 KB SO_RCVBUF stalls for --stall seconds while another
+client sends --lines numbered 1000 byte lines. With a small --tx-hwm the
+server must drop or disconnect, and it may lose whole lines. It must never
+deliver part of one. Runs every configuration in --configs (server options,
+configurations separated by semicolons) and prints lines received, cut lines,
+and whether the sequence numbers stayed in order.
+"""
+import socket
+import threading
+import time
+
+import chatbench
+
+LINE = 1000
+DEFAULT_CONFIGS = [
+    "--tx-overflow=drop-newest",
+    "--tx-overflow=drop-oldest",
+    "--tx-overflow=drop-newest --workers=2",
+    "--tx-overflow=drop-oldest --relay=splice",
+]
+
+
+def run(a, args):
+    with chatbench.Server(a.server, a.port, args):
+        reader = socket.socket()
+        reader.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+        reader.connect(("127.0.0.1", a.port))
+        sender = socket.create_connection(("127.0.0.1", a.port))
+        time.sleep(0.2)
+        reader.recv(100)
+        sender.recv(100)
+
+        def send():
+            for i in range(a.lines):
+                sender.sendall(b"%08d" % i + b"x" * (LINE - 9) + b"\n")
+                time.sleep(0.0002)
+
+        t = threading.Thread(target=send)
+        t.start()
+        time.sleep(a.stall)
+
+        got = bytearray()
+        reader.settimeout(1)
+        try:
+            while True:
+                d = reader.recv(65536)
+                if not d:
+                    break
+                got += d
+        except (socket.timeout, ConnectionResetError):
+            pass
+        t.join()
+        sender.close()
+        reader.close()
+
+    lines = bytes(got).split(b"\n")[:-1]
+    cut = sum(1 for l in lines if len(l) != LINE - 1 or not l[:8].isdigit() or l[8:] != b"x" * (LINE - 9))
+    seq = [int(l[:8]) for l in lines if l[:8].isdigit()]
+    return len(lines), cut, all(x < y for x, y in zip(seq, seq[1:]))
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--lines", type=int, default=10000)
+    p.add_argument("--stall", type=float, default=4)
+    p.add_argument("--hwm", default="--tx-hwm=100 --tx-lwm=50", help="queue bounds for every config")
+    p.add_argument("--configs", default=";".join(DEFAULT_CONFIGS), help="semicolon separated server configs")
+    a = p.parse_args()
+
+    print("%-45s %8s %6s %8s" % ("config", "lines", "cut", "ordered"))
+    for config in a.configs.split(";"):
+        args = a.server_args.split() + a.hwm.split() + config.split()
+        lines, cut, ordered = run(a, args)
+        print("%-45s %8d %6d %8s" % (config, lines, cut, ordered))
+
+
+if __name__ == "__main__":
+    main()
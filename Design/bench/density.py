@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+user-016: server RSS per idle connection.
+
+Holder processes open --conns loopback connections between them, each bound
+to one of the 127.0.0.x source addresses so no source runs out of ephemeral
+ports, and then keep them idle. The server's RSS growth over its idle
+baseline, divided by the connections it holds, is reported for every
+--loops count, and for --baseline. Both ends need an fd limit above their
+share of --conns. Holders take at most --per-holder connections each, and
+the server needs one fd per connection, so a lower hard limit caps the run.
+"""
+import resource
+import subprocess
+import sys
+import time
+
+import chatbench
+
+# Runs in each holder: connect, report, hold until stdin closes
+HOLDER = """
+import socket, sys
+port, n, sources = int(sys.argv[1]), int(sys.argv[2]), sys.argv[3].split(",")
+conns = []
+for i in range(n):
+    s = socket.socket()
+    s.bind((sources[i % len(sources)], 0))
+    s.connect(("127.0.0.1", port))
+    conns.append(s)
+print(len(conns), flush=True)
+sys.stdin.read()
+"""
+
+PORTS_PER_SOURCE = 25000
+
+
+def raise_fd_limit():
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+    return hard
+
+
+def measure(a, server, args, conns):
+    with chatbench.Server(server, a.port, args) as srv:
+        time.sleep(0.5)
+        base = srv.rss_kb()
+
+        sources = ["127.0.0.%d" % (i + 1) for i in range(max(1, -(-conns // PORTS_PER_SOURCE)))]
+        holders = []
+        left = conns
+        while left > 0:
+            n = min(left, a.per_holder)
+            holders.append(subprocess.Popen([sys.executable, "-c", HOLDER, str(a.port), str(n), ",".join(sources)],
+                                            stdin=subprocess.PIPE, stdout=subprocess.PIPE, text=True))
+            left -= n
+        held = sum(int(h.stdout.readline() or 0) for h in holders)
+
+        time.sleep(a.settle)
+        rss = srv.rss_kb()
+        alive = srv.alive()
+        for h in holders:
+            h.stdin.close()
+            h.wait()
+
+    if not alive or held != conns:
+        raise RuntimeError("held %d of %d connections" % (held, conns))
+    return base, rss, (rss - base) * 1024 / conns
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--baseline", help="server binary to compare against")
+    p.add_argument("--conns", type=int, default=100000)
+    p.add_argument("--per-holder", type=int, default=10000, help="connections per holder process")
+    p.add_argument("--loops", default="1,4", help="comma separated loop counts")
+    p.add_argument("--settle", type=float, default=1.5, help="seconds between the last connect and the RSS sample")
+    a = p.parse_args()
+
+    # The server and the holders inherit it
+    limit = raise_fd_limit()
+    conns = min(a.conns, limit - 64)
+    if conns < a.conns:
+        print("fd hard limit %d, holding %d connections instead of %d" % (limit, conns, a.conns))
+
+    print("%10s %6s %8s %13s %13s %10s" % ("server", "loops", "conns", "idle rss KB", "held rss KB", "B/conn"))
+    for name, server, extra in [("current", a.server, a.server_args.split())] + \
+            ([("baseline", a.baseline, [])] if a.baseline else []):
+        for loops in [int(x) for x in a.loops.split(",")]:
+            base, rss, per = measure(a, server, extra + ["--loops=%d" % loops], conns)
+            print("%10s %6d %8d %13d %13d %10.0f" % (name, loops, conns, base, rss, per))
+
+
+if __name__ == "__main__":
+    main()
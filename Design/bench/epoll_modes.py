@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""
+user-021: events/s and syscalls per event for each epoll mode.
+
+Runs the server under libSysCount.so with --stats=1 while --senders of
+--conns clients chat --size byte lines at --rate lines/s each, once per
+configuration in --configs (server options, configurations separated by
+semicolons). Reports events/s and epoll syscalls per event from the
+server's --stats, and from the counters epoll_ctl/s and all socket and
+epoll syscalls per event.
+"""
+import time
+
+import chatbench
+
+DEFAULT_CONFIGS = [
+    "--epoll-mode=et",
+    "--epoll-mode=oneshot",
+    "--workers=2",
+]
+IO_CALLS = ["epoll_ctl", "epoll_wait", "send", "sendmsg", "recv", "recvmsg"]
+
+
+def measure(a, args):
+    with chatbench.Server(a.server, a.port, args + ["--stats=1"], syscount=a.syscount) as srv:
+        load = chatbench.start_load(a.load, a.port, conns=a.conns, senders=a.senders, size=a.size,
+                                    rate=a.rate, warmup=1, secs=a.secs)
+        time.sleep(1.5)
+        c0, n0 = srv.counters(), len(srv.stats())
+        time.sleep(a.secs - 1)
+        d, lines = chatbench.delta(srv.counters(), c0), srv.stats()[n0:]
+        r = chatbench.finish_load(load)
+
+    lines = [l for l in lines if "events/s" in l]
+    events = sum(l["events/s"] for l in lines) / max(1, len(lines))
+    per = sum(l.get("epoll syscalls/event", 0) for l in lines) / max(1, len(lines))
+    window = a.secs - 1
+    calls = sum(d[k] for k in IO_CALLS) / window
+    return float(r["delivered_msgs/s"]), events, per, d["epoll_ctl"] / window, calls / max(1, events)
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--configs", default=";".join(DEFAULT_CONFIGS), help="semicolon separated server configs")
+    p.add_argument("--conns", type=int, default=30)
+    p.add_argument("--senders", type=int, default=4)
+    p.add_argument("--size", type=int, default=64)
+    p.add_argument("--rate", type=int, default=200, help="lines/s per sender")
+    p.add_argument("--secs", type=int, default=6)
+    a = p.parse_args()
+
+    print("%-22s %16s %10s %18s %12s %16s" % ("config", "delivered msgs/s", "events/s", "epoll calls/event",
+                                            "epoll_ctl/s", "syscalls/event"))
+    for config in a.configs.split(";"):
+        delivered, events, per, ctl, calls = measure(a, a.server_args.split() + config.split())
+        print("%-22s %16.0f %10.0f %18.2f %12.0f %16.2f" % (config, delivered, events, per, ctl, calls))
+
+
+if __name__ == "__main__":
+    main()
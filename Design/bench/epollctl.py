@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+user-007: epoll_ctl calls against send calls under broadcast load.
+
+Runs the server under libSysCount.so while --senders publish --size byte
+lines at --rate lines/s each to every other client, and reports per second
+the epoll_ctl and send()+sendmsg() calls the server made, epoll_ctl per
+delivered message, and the server's CPU use. The server's own --stats
+figure is printed too when --server-args has --stats.
+"""
+import chatbench
+
+
+def measure(a, server, args):
+    with chatbench.Server(server, a.port, args, syscount=a.syscount) as srv:
+        c0, cpu0 = srv.counters(), srv.cpu()
+        r = chatbench.run_load(a.load, a.port, conns=a.conns, senders=a.senders, size=a.size,
+                               rate=a.rate, warmup=1, secs=a.secs)
+        d, cpu = chatbench.delta(srv.counters(), c0), srv.cpu() - cpu0
+        stats = srv.stats()
+
+    secs = a.secs + 1
+    delivered = float(r["delivered_msgs/s"])
+    reported = stats[-1].get("epoll_ctl/s") if stats else None
+    return (delivered, d["epoll_ctl"] / secs, (d["send"] + d["sendmsg"]) / secs,
+            d["epoll_ctl"] / (delivered * secs), cpu / secs, reported)
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--baseline", help="server binary to compare against")
+    p.add_argument("--conns", type=int, default=100)
+    p.add_argument("--senders", type=int, default=100)
+    p.add_argument("--size", type=int, default=64)
+    p.add_argument("--rate", type=int, default=100, help="lines/s per sender")
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    servers = [("current", a.server, a.server_args.split())]
+    if a.baseline:
+        servers.append(("baseline", a.baseline, []))
+
+    print("%10s %16s %12s %12s %12s %10s %14s" % ("server", "delivered msgs/s", "epoll_ctl/s", "sends/s",
+                                                "ctl/msg", "server cpu", "--stats ctl/s"))
+    for name, server, args in servers:
+        delivered, ctl, sends, per, cpu, reported = measure(a, server, args)
+        print("%10s %16.0f %12.0f %12.0f %12.3f %9.0f%% %14s" % (name, delivered, ctl, sends, per, cpu * 100,
+                                                              "-" if reported is None else "%.0f" % reported))
+
+
+if __name__ == "__main__":
+    main()
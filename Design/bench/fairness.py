@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""
+user-020: quiet clients stay responsive while one client floods.
+
+One client floods 64 KB writes at a one-loop server. Meanwhile --quiet
+clients connect one after another, and each times connect to greeting, an
+accept and a send the loop has to fit in between the flooder's reads.
+Reports p50/p99/max of those times for every --read-budget in --budgets
+(0 drains each socket to EAGAIN, as before the budget).
+"""
+import socket
+import threading
+import time
+
+import chatbench
+
+
+def run(a, args):
+    with chatbench.Server(a.server, a.port, args):
+        stop = threading.Event()
+
+        def flood():
+            s = socket.create_connection(("127.0.0.1", a.port))
+            chunk = b"f" * 65536
+            try:
+                while not stop.is_set():
+                    s.sendall(chunk)
+            except OSError:
+                pass
+            s.close()
+
+        t = threading.Thread(target=flood)
+        t.start()
+        time.sleep(0.5)
+
+        lat = []
+        for _ in range(a.quiet):
+            t0 = time.perf_counter()
+            c = socket.create_connection(("127.0.0.1", a.port))
+            c.recv(100)
+            lat.append((time.perf_counter() - t0) * 1e3)
+            c.close()
+        stop.set()
+        t.join()
+    return lat
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--budgets", default="0,262144,65536", help="comma separated --read-budget values")
+    p.add_argument("--quiet", type=int, default=300, help="quiet clients timed")
+    a = p.parse_args()
+
+    print("%12s %10s %10s %10s" % ("read budget", "p50 ms", "p99 ms", "max ms"))
+    for budget in a.budgets.split(","):
+        lat = run(a, a.server_args.split() + ["--loops=1", "--read-budget=" + budget])
+        print("%12s %10.2f %10.2f %10.2f" % (budget, chatbench.percentile(lat, 0.5), chatbench.percentile(lat, 0.99),
+                                             max(lat)))
+
+
+if __name__ == "__main__":
+    main()
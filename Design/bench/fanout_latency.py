@@ -0,0 +1,32 @@
+#!/usr/bin/env python3
+"""
+user-008: fan-out latency with and without the inline send fast path.
+
+One sender publishes --size byte lines at --rate lines/s, each stamped with
+its send time, to rooms of --recipients clients. ChatLoad times every
+delivery against the stamp. The server runs with --inline-send=0 and =1.
+"""
+import chatbench
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--recipients", default="10,100,1000", help="comma separated room sizes")
+    p.add_argument("--size", type=int, default=64)
+    p.add_argument("--rate", type=int, default=1000)
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    print("%10s %7s %10s %10s %10s %10s" % ("recipients", "inline", "samples", "p50 us", "p99 us", "max us"))
+    for n in [int(x) for x in a.recipients.split(",")]:
+        for inline in (0, 1):
+            args = a.server_args.split() + ["--inline-send=%d" % inline]
+            with chatbench.Server(a.server, a.port, args) as srv:
+                r = chatbench.run_load(a.load, a.port, conns=n + 1, senders=1, size=a.size, rate=a.rate,
+                                       latency=True, warmup=1, secs=a.secs)
+            print("%10d %7d %10s %10s %10s %10s" % (n, inline, r["samples"], r["p50_us"], r["p99_us"],
+                                                     r["max_us"]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+user-006: send syscalls per delivered message in a 64 byte flood.
+
+Runs the server under libSysCount.so while --senders publish --size byte
+lines to every other client at --rate lines/s each. Paced like that, lines
+reach the server one or a few at a time, so each becomes its own broadcast
+rather than one 4 KB chunk. Receivers read with a small SO_RCVBUF, so send
+queues build up and each flush has several messages to gather. Flat out, the
+server would read and forward whole chunks and there would be little to
+gather. Reports delivered msgs/s,
+send()+sendmsg() calls per delivered message and the server's CPU use, for
+the server and for --baseline.
+"""
+import chatbench
+
+
+def measure(a, server, args, rate):
+    with chatbench.Server(server, a.port, args, syscount=a.syscount) as srv:
+        c0, cpu0 = srv.counters(), srv.cpu()
+        r = chatbench.run_load(a.load, a.port, conns=a.conns, senders=a.senders, size=a.size,
+                               rate=rate, rcvbuf=a.rcvbuf, warmup=1, secs=a.secs)
+        d, cpu = chatbench.delta(srv.counters(), c0), srv.cpu() - cpu0
+
+    # Counters cover warmup too, so scale by everything ChatLoad received in the run
+    delivered = float(r["delivered_msgs/s"])
+    total = delivered * (a.secs + 1)
+    return delivered, (d["send"] + d["sendmsg"]) / total, cpu / (a.secs + 1)
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--baseline", help="server binary to compare against")
+    p.add_argument("--conns", type=int, default=100)
+    p.add_argument("--senders", type=int, default=100)
+    p.add_argument("--size", type=int, default=64)
+    p.add_argument("--rate", default="100,200", help="comma separated lines/s per sender")
+    p.add_argument("--rcvbuf", type=int, default=4096)
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    servers = [("current", a.server, a.server_args.split())]
+    if a.baseline:
+        servers.append(("baseline", a.baseline, []))
+    print("%10s %8s %16s %12s %10s" % ("server", "rate", "delivered msgs/s", "sends/msg", "server cpu"))
+    for name, server, args in servers:
+        for rate in [int(x) for x in a.rate.split(",")]:
+            delivered, sends, cpu = measure(a, server, args, rate)
+            print("%10s %8d %16.0f %12.3f %9.0f%%" % (name, rate, delivered, sends, cpu * 100))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""
+user-024: poll server wakeup cost as idle connections grow.
+
+Holds N idle connections open for every N in --idle, then has ChatLoad run
+--cycles connect/greeting/close cycles. Each cycle wakes the loop twice
+without broadcasting, so the server CPU per cycle is mostly the cost of
+a wakeup at that many fds. Reports server user and system microseconds per
+cycle, for --server (a poll server) and --baseline. N is capped below the
+fd limit, since the server and this script each hold one fd per connection.
+"""
+import resource
+import socket
+import time
+
+import chatbench
+
+
+def measure(a, server, args, idle):
+    with chatbench.Server(server, a.port, args) as srv:
+        conns = [socket.create_connection(("127.0.0.1", a.port)) for _ in range(idle)]
+        time.sleep(1.0)
+        u0, s0 = chatbench.cpu_seconds(srv.pid)
+        r = chatbench.run_load(a.load, a.port, connect_only=True, count=a.cycles)
+        u1, s1 = chatbench.cpu_seconds(srv.pid)
+        for c in conns:
+            c.close()
+
+    n = int(r["connects"])
+    return (u1 - u0) * 1e6 / n, (s1 - s0) * 1e6 / n
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--baseline", help="poll server binary that rebuilds its pollfd set every wakeup")
+    p.add_argument("--idle", default="1000,5000,20000", help="comma separated idle connection counts")
+    p.add_argument("--cycles", type=int, default=5000, help="connect/close cycles per run")
+    a = p.parse_args()
+
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+
+    servers = [("current", a.server, a.server_args.split())]
+    if a.baseline:
+        servers.append(("baseline", a.baseline, []))
+
+    print("%10s %8s %14s %14s" % ("server", "idle", "user us/cycle", "sys us/cycle"))
+    for n in [int(x) for x in a.idle.split(",")]:
+        idle = min(n, hard - 64)
+        for name, server, args in servers:
+            user, sys_ = measure(a, server, args, idle)
+            print("%10s %8d %14.1f %14.1f" % (name, idle, user, sys_))
+
+
+if __name__ == "__main__":
+    main()
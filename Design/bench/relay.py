@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+"""
+user-012: CPU and syscalls per relayed byte, --relay=copy against splice/tee.
+
+--senders publish --size byte lines, paced at --mbps MB/s each, to --conns
+clients. The server runs under libSysCount.so with each relay mode, and the
+script reports delivered MB/s, server CPU seconds per GB delivered and the
+relay syscalls per MB: recv and send calls for the copy path, splice and tee
+calls for the kernel-side one. The VM has no perf counters, so memory
+bandwidth is not measured directly. The copy path moves every byte through
+user space once per recv and once per recipient, splice/tee not at all.
+"""
+import chatbench
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--sizes", default="4096,65536", help="comma separated line sizes")
+    p.add_argument("--conns", type=int, default=10)
+    p.add_argument("--senders", type=int, default=1)
+    p.add_argument("--mbps", type=float, default=50, help="MB/s each sender publishes")
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    print("%8s %7s %10s %10s %10s %10s %10s %10s" % ("size", "relay", "MB/s", "cpu s/GB", "recv/MB", "send/MB",
+                                                     "splice/MB", "tee/MB"))
+    for size in [int(x) for x in a.sizes.split(",")]:
+        for relay in ("copy", "splice"):
+            args = a.server_args.split() + ["--relay=" + relay]
+            with chatbench.Server(a.server, a.port, args, syscount=a.syscount) as srv:
+                c0, cpu0 = srv.counters(), srv.cpu()
+                r = chatbench.run_load(a.load, a.port, conns=a.conns, senders=a.senders, size=size,
+                                       rate=max(1, int(a.mbps * 1e6 / size)), warmup=1, secs=a.secs)
+                d, cpu = chatbench.delta(srv.counters(), c0), srv.cpu() - cpu0
+
+            secs = a.secs + 1
+            mb = float(r["delivered_MB/s"]) * secs
+            print("%8d %7s %10.1f %10.3f %10.1f %10.1f %10.1f %10.1f" % (
+                size, relay, mb / secs, cpu / (mb / 1000), (d["recv"] + d["recvmsg"]) / mb,
+                (d["send"] + d["sendmsg"]) / mb, d["splice"] / mb, d["tee"] / mb))
+
+
+if __name__ == "__main__":
+    main()
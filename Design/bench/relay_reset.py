@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+user-012: the splice relay survives recipients that go away mid-stream.
+
+Two cases, each run --runs times against a fresh --relay=splice server:
+  reset     one client floods 64 KB chunks while batches of 8 receivers
+            connect, take their greeting and close with SO_LINGER 0
+  overflow  one client floods 16 KB chunks at a reader stalled behind a
+            4 KB SO_RCVBUF until --tx-hwm=1MB cuts it off
+A run passes if the server is still up and greets a fresh client at the end.
+"""
+import socket
+import struct
+import threading
+import time
+
+import chatbench
+
+CASE_ARGS = {
+    "reset": ["--relay=splice"],
+    "overflow": ["--relay=splice", "--tx-hwm=1048576", "--tx-lwm=262144"],
+}
+
+
+def flood(port, chunk, stop):
+    s = socket.create_connection(("127.0.0.1", port))
+    s.setblocking(False)
+    data = b"r" * chunk
+    while not stop.is_set():
+        try:
+            s.send(data)
+        except BlockingIOError:
+            time.sleep(0.0005)
+        except OSError:
+            break
+        try:
+            while s.recv(1 << 20):
+                pass
+        except BlockingIOError:
+            pass
+        except OSError:
+            break
+    s.close()
+
+
+def reset_receivers(port, secs):
+    t0 = time.time()
+    while time.time() - t0 < secs:
+        try:
+            batch = [socket.create_connection(("127.0.0.1", port)) for _ in range(8)]
+            for c in batch:
+                c.recv(4096)
+        except OSError:
+            return  # server is gone
+        time.sleep(0.01)
+        for c in batch:
+            c.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack("ii", 1, 0))
+            c.close()
+
+
+def stalled_reader(port, secs):
+    r = socket.socket()
+    r.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+    r.connect(("127.0.0.1", port))
+    time.sleep(secs)
+    r.close()
+
+
+def run(a, case):
+    with chatbench.Server(a.server, a.port, a.server_args.split() + CASE_ARGS[case]) as srv:
+        if case == "overflow":
+            # Reader first, so it is a recipient from the first chunk on
+            reader = threading.Thread(target=stalled_reader, args=(a.port, a.secs))
+            reader.start()
+            time.sleep(0.1)
+
+        stop = threading.Event()
+        sender = threading.Thread(target=flood, args=(a.port, 65536 if case == "reset" else 16384, stop))
+        sender.start()
+        if case == "reset":
+            reset_receivers(a.port, a.secs)
+        else:
+            reader.join()
+        stop.set()
+        sender.join()
+
+        if not srv.alive():
+            return False
+        try:
+            c = socket.create_connection(("127.0.0.1", a.port), timeout=2)
+            ok = c.recv(100).startswith(b"Welcome")
+            c.close()
+            return ok
+        except OSError:
+            return False
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--cases", default="reset,overflow")
+    p.add_argument("--runs", type=int, default=3)
+    p.add_argument("--secs", type=float, default=4)
+    a = p.parse_args()
+
+    for case in a.cases.split(","):
+        alive = sum(1 for _ in range(a.runs) if run(a, case))
+        print("%-9s server alive after %d of %d runs" % (case, alive, a.runs))
+
+
+if __name__ == "__main__":
+    main()
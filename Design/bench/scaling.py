@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+"""
+user-001: msgs/s as the number of reactor loops grows.
+
+Every run starts the server with --loops=N, connects --conns clients of which
+--senders publish --size byte lines flat out, and reports what the receivers
+got per second along with the server's CPU use. Scaling is only visible with
+cores to spare for both the server and ChatLoad.
+"""
+import os
+
+import chatbench
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--loops", default="1,2,4", help="comma separated loop counts")
+    p.add_argument("--conns", type=int, default=200)
+    p.add_argument("--senders", type=int, default=8)
+    p.add_argument("--size", type=int, default=64)
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    print("cores: %d" % os.cpu_count())
+    print("%6s %16s %16s %10s" % ("loops", "delivered msgs/s", "sent msgs/s", "server cpu"))
+    for loops in [int(x) for x in a.loops.split(",")]:
+        with chatbench.Server(a.server, a.port, ["--loops=%d" % loops]) as srv:
+            cpu0 = srv.cpu()
+            r = chatbench.run_load(a.load, a.port, conns=a.conns, senders=a.senders, size=a.size,
+                                   secs=a.secs, warmup=1)
+            cpu = (srv.cpu() - cpu0) / (a.secs + 1)
+        print("%6d %16s %16s %9.0f%%" % (loops, r["delivered_msgs/s"], r["sent_msgs/s"], cpu * 100))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+user-018: server RSS stays bounded with a reader that never reads.
+
+One client with a 4 KB SO_RCVBUF connects and never reads, one drains
+everything, and a third floods 16 KB lines for --secs seconds. Every
+--tx-overflow policy runs with --hwm, next to an unbounded queue
+(--tx-hwm=0) that only floods for --unbounded-secs, it grows by GBs a
+second. Reports MB flooded, the server's peak RSS, and the per-policy
+counters from its last --stats line.
+"""
+import socket
+import time
+
+import chatbench
+
+POLICIES = ["drop-newest", "drop-oldest", "disconnect"]
+COUNTERS = ["dropped newest", "oldest", "disconnects"]
+
+
+def drain(s):
+    # Bounded, a reader kept busy by the flood must not starve the writer
+    try:
+        for _ in range(16):
+            if not s.recv(1 << 20):
+                break
+    except (BlockingIOError, ConnectionResetError):
+        pass
+
+
+def run(a, args, secs):
+    with chatbench.Server(a.server, a.port, args + ["--stats=1"]) as srv:
+        slow = socket.socket()
+        slow.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+        slow.connect(("127.0.0.1", a.port))
+        fast = socket.create_connection(("127.0.0.1", a.port))
+        writer = socket.create_connection(("127.0.0.1", a.port))
+        fast.setblocking(False)
+        writer.setblocking(False)
+        time.sleep(0.2)
+
+        msg = b"y" * (16384 - 1) + b"\n"
+        sent = 0
+        t0 = time.time()
+        while time.time() - t0 < secs:
+            try:
+                sent += writer.send(msg)
+            except BlockingIOError:
+                time.sleep(0.001)
+            drain(fast)
+            drain(writer)
+
+        time.sleep(1.1)  # one more stats line
+        peak = srv.peak_rss_kb()
+        stats = srv.stats()
+        for s in (slow, fast, writer):
+            s.close()
+
+    # The counters follow other fields, so match their names by suffix
+    last = stats[-1] if stats else {}
+    counters = [next((int(v) for k, v in last.items() if k.endswith(c)), 0) for c in COUNTERS]
+    return sent / (1 << 20), peak, counters
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--secs", type=float, default=10)
+    p.add_argument("--unbounded-secs", type=float, default=3)
+    p.add_argument("--hwm", default="--tx-hwm=1048576 --tx-lwm=262144", help="queue bounds for the policy runs")
+    a = p.parse_args()
+
+    runs = [("unbounded", ["--tx-hwm=0"], a.unbounded_secs)]
+    runs += [(policy, a.hwm.split() + ["--tx-overflow=" + policy], a.secs) for policy in POLICIES]
+
+    print("%12s %6s %10s %13s %12s %12s %12s" % ("policy", "secs", "MB sent", "peak rss KB", "drop newest", "drop oldest",
+                                            "disconnects"))
+    for name, args, secs in runs:
+        mb, peak, counters = run(a, a.server_args.split() + args, secs)
+        print("%12s %6.0f %10.0f %13d %12d %12d %12d" % ((name, secs, mb, peak) + tuple(counters)))
+
+
+if __name__ == "__main__":
+    main()
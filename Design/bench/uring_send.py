@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+user-010: syscalls per broadcast with sends batched through io_uring.
+
+One sender publishes --size byte lines at --rate lines/s to rooms of
+--recipients clients. The server runs under libSysCount.so with
+--uring-send=0 and =1, and the script reports per broadcast the send calls,
+io_uring_enter calls and all I/O syscalls the shim counts, then delivered
+msgs/s and the server CPU time per broadcast.
+"""
+import time
+
+import chatbench
+
+IO_CALLS = ["send", "sendmsg", "recv", "recvmsg", "epoll_ctl", "epoll_wait", "io_uring_enter", "read", "write"]
+
+
+def measure(a, recipients, uring):
+    args = a.server_args.split() + ["--uring-send=%d" % uring]
+    with chatbench.Server(a.server, a.port, args, syscount=a.syscount) as srv:
+        load = chatbench.start_load(a.load, a.port, conns=recipients + 1, senders=1, size=a.size,
+                                    rate=a.rate, warmup=a.warmup, secs=a.secs)
+        time.sleep(a.warmup + 0.5)
+        c0, cpu0 = srv.counters(), srv.cpu()
+        time.sleep(a.secs - 1)
+        d, cpu = chatbench.delta(srv.counters(), c0), srv.cpu() - cpu0
+        r = chatbench.finish_load(load)
+
+    lines = float(r["sent_msgs/s"]) * (a.secs - 1)
+    return ((d["send"] + d["sendmsg"]) / lines, d["io_uring_enter"] / lines,
+            sum(d[k] for k in IO_CALLS) / lines, float(r["delivered_msgs/s"]), cpu / lines * 1e6)
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--recipients", default="1000,10000", help="comma separated room sizes")
+    p.add_argument("--size", type=int, default=64)
+    p.add_argument("--rate", type=int, default=20)
+    p.add_argument("--warmup", type=int, default=3)
+    p.add_argument("--secs", type=int, default=6)
+    a = p.parse_args()
+
+    print("%10s %6s %12s %12s %14s %16s %14s" % ("recipients", "uring", "sends/bcast", "enters/bcast",
+                                                 "syscalls/bcast", "delivered msgs/s", "cpu us/bcast"))
+    for n in [int(x) for x in a.recipients.split(",")]:
+        for uring in (0, 1):
+            sends, enters, total, delivered, cpu = measure(a, n, uring)
+            print("%10d %6d %12.1f %12.2f %14.1f %16.0f %14.0f" % (n, uring, sends, enters, total, delivered, cpu))
+
+
+if __name__ == "__main__":
+    main()
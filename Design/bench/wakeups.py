@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""
+user-025: idle wakeups and enqueue-to-send latency.
+
+Idle: starts --server and --baseline with no clients and counts the
+voluntary context switches of all their threads, and their CPU, over
+--idle-secs. Every wakeup of a blocked loop is one switch.
+
+Latency: a peer connects to --server, and every client binary in
+--clients and --baseline-clients connects next to it. Each then gets
+--lines short lines on stdin, paced 130 ms apart. Reports p50/max from the
+write to the client's stdin until the peer receives the broadcast, and
+how long /quit takes to end the client. A client that doesn't deliver
+within 5 s is reported as hung.
+"""
+import glob
+import socket
+import subprocess
+import time
+
+import chatbench
+
+
+def wakeups(pid):
+    total = 0
+    for path in glob.glob("/proc/%d/task/*/status" % pid):
+        with open(path) as f:
+            for line in f:
+                if line.startswith("voluntary_ctxt_switches:"):
+                    total += int(line.split()[1])
+    return total
+
+
+def idle(a, server):
+    with chatbench.Server(server, a.port) as srv:
+        time.sleep(0.5)
+        w0, cpu0 = wakeups(srv.pid), srv.cpu()
+        time.sleep(a.idle_secs)
+        return wakeups(srv.pid) - w0, srv.cpu() - cpu0
+
+
+def latency(a, client):
+    peer = socket.create_connection(("127.0.0.1", a.port))
+    peer.settimeout(5)
+    peer.recv(100)
+    proc = subprocess.Popen([client, str(a.port), "127.0.0.1"], stdin=subprocess.PIPE,
+                            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    time.sleep(0.5)
+
+    lat = []
+    try:
+        for i in range(a.lines):
+            time.sleep(0.13)
+            line = b"m%d\n" % i
+            t0 = time.time()
+            proc.stdin.write(line)
+            proc.stdin.flush()
+            buf = b""
+            while not buf.endswith(line):
+                buf += peer.recv(100)
+            lat.append((time.time() - t0) * 1e3)
+    except socket.timeout:
+        proc.kill()
+        proc.wait()
+        peer.close()
+        return None
+
+    t0 = time.time()
+    proc.stdin.write(b"/quit\n")
+    proc.stdin.flush()
+    try:
+        proc.wait(5)
+        quit_ms = (time.time() - t0) * 1e3
+    except subprocess.TimeoutExpired:
+        proc.kill()
+        proc.wait()
+        quit_ms = None
+    peer.close()
+    return chatbench.percentile(lat, 0.5), max(lat), quit_ms
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--baseline", help="server binary with the timed poll loop")
+    p.add_argument("--clients", default="", help="comma separated client binaries")
+    p.add_argument("--baseline-clients", default="", help="comma separated client binaries to compare against")
+    p.add_argument("--idle-secs", type=float, default=5)
+    p.add_argument("--lines", type=int, default=20)
+    a = p.parse_args()
+
+    print("%10s %16s %14s" % ("server", "idle wakeups", "idle cpu ms"))
+    for name, server in [("current", a.server)] + ([("baseline", a.baseline)] if a.baseline else []):
+        n, cpu = idle(a, server)
+        print("%10s %16d %14.1f" % (name, n, cpu * 1e3))
+
+    runs = [("current", c) for c in a.clients.split(",") if c]
+    runs += [("baseline", c) for c in a.baseline_clients.split(",") if c]
+    if not runs:
+        return
+
+    print()
+    print("%-40s %10s %10s %10s" % ("client", "p50 ms", "max ms", "/quit ms"))
+    with chatbench.Server(a.server, a.port):
+        for name, client in runs:
+            r = latency(a, client)
+            label = "%s %s" % (name, client)
+            if r is None:
+                print("%-40s %10s %10s %10s" % (label, "hung", "-", "-"))
+                continue
+            p50, worst, quit_ms = r
+            print("%-40s %10.2f %10.2f %10s" % (label, p50, worst, "-" if quit_ms is None else "%.1f" % quit_ms))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+user-022: sharded reactors against the shared-epoll worker pool.
+
+Both scaling models get the same load. --senders of --conns clients
+publish --size byte lines flat out, then ChatLoad churns connect/close
+cycles for --secs seconds. Reports delivered msgs/s, events/s and epoll
+syscalls per event from the server's --stats, the server's CPU use, and
+connects/s, for --loops=N and --workers=N at every N in --threads.
+"""
+import time
+
+import chatbench
+
+
+def measure(a, args):
+    with chatbench.Server(a.server, a.port, args + ["--stats=1"]) as srv:
+        cpu0 = srv.cpu()
+        load = chatbench.start_load(a.load, a.port, conns=a.conns, senders=a.senders, size=a.size,
+                                    warmup=1, secs=a.secs)
+        time.sleep(1.5)
+        n0 = len(srv.stats())
+        r = chatbench.finish_load(load)
+        lines = [l for l in srv.stats()[n0:] if "events/s" in l][:a.secs - 1]
+        cpu = (srv.cpu() - cpu0) / (a.secs + 1)
+        c = chatbench.run_load(a.load, a.port, connect_only=True, secs=a.secs)
+
+    events = sum(l["events/s"] for l in lines) / max(1, len(lines))
+    per = sum(l.get("epoll syscalls/event", 0) for l in lines) / max(1, len(lines))
+    return float(r["delivered_msgs/s"]), events, per, cpu, float(c["connects/s"])
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--threads", default="1,4", help="comma separated loop/worker counts")
+    p.add_argument("--conns", type=int, default=30)
+    p.add_argument("--senders", type=int, default=4)
+    p.add_argument("--size", type=int, default=64)
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    print("%-12s %16s %10s %18s %10s %11s" % ("config", "delivered msgs/s", "events/s", "epoll calls/event",
+                                            "server cpu", "connects/s"))
+    for n in a.threads.split(","):
+        for model in ("loops", "workers"):
+            config = "--%s=%s" % (model, n)
+            delivered, events, per, cpu, connects = measure(a, a.server_args.split() + [config])
+            print("%-12s %16.0f %10.0f %18.2f %9.0f%% %11.0f" % (config, delivered, events, per, cpu * 100,
+                                                                connects))
+
+
+if __name__ == "__main__":
+    main()
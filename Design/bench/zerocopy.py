@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+"""
+user-011: server CPU per GB delivered, MSG_ZEROCOPY against the copy path.
+
+--senders publish lines of each of --sizes bytes to --conns clients, paced
+at --mbps MB/s each so that both paths keep up, once with the server's
+default copy path and once with --zerocopy=--threshold. The
+server reads at most 64 KB per recv, so larger lines are broadcast as 64 KB
+chunks. Over loopback the kernel has to copy into the receiver anyway and
+reports the sends as copied, so the gain only shows on a real NIC.
+"""
+import chatbench
+
+
+def main():
+    p = chatbench.parser(__doc__)
+    p.add_argument("--sizes", default="65536,1048576", help="comma separated line sizes")
+    p.add_argument("--threshold", type=int, default=32768)
+    p.add_argument("--conns", type=int, default=10)
+    p.add_argument("--senders", type=int, default=1)
+    p.add_argument("--mbps", type=float, default=50, help="MB/s each sender publishes")
+    p.add_argument("--secs", type=int, default=5)
+    a = p.parse_args()
+
+    print("%9s %9s %14s %12s %14s" % ("size", "mode", "delivered MB/s", "server cpu", "cpu s/GB"))
+    for size in [int(x) for x in a.sizes.split(",")]:
+        for mode, extra in (("copy", []), ("zerocopy", ["--zerocopy=%d" % a.threshold])):
+            with chatbench.Server(a.server, a.port, a.server_args.split() + extra) as srv:
+                cpu0 = srv.cpu()
+                r = chatbench.run_load(a.load, a.port, conns=a.conns, senders=a.senders, size=size,
+                                       rate=max(1, int(a.mbps * 1e6 / size)), warmup=1, secs=a.secs)
+                cpu = srv.cpu() - cpu0
+
+            secs = a.secs + 1
+            mbs = float(r["delivered_MB/s"])
+            print("%9d %9s %14.1f %11.0f%% %14.3f" % (size, mode, mbs, cpu / secs * 100,
+                                                      cpu / (mbs * secs / 1000)))
+
+
+if __name__ == "__main__":
+    main()
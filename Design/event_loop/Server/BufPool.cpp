@@ -0,0 +1,126 @@
+#include "BufPool.h"
+#include "MsgBuf.h"
+
+//
+// === BufPool functions ===
+//
+
+BufPool::~BufPool()
+{
+  for (auto& c : m_classes)
+  {
+    FreeList(c.local);
+    FreeList(c.returned.exchange(nullptr, std::memory_order_acquire));
+  }
+}
+
+/// <summary>
+/// Empty buffer of the given class holding one reference.
+/// Allocates only when both the local and the returned lists are empty.
+/// </summary>
+MsgBuf* BufPool::Acquire(size_t cls)
+{
+  SizeClass& c = m_classes[cls];
+
+  if (c.local == nullptr)
+  {
+    // Take everything other threads returned in one go
+    MsgBuf* head = c.returned.exchange(nullptr, std::memory_order_acquire);
+    while (head != nullptr)
+    {
+      MsgBuf* next = head->m_next;
+      if (c.localCount < MAX_FREE)
+      {
+        head->m_next = c.local;
+        c.local = head;
+        ++c.localCount;
+      }
+      else
+      {
+        MsgBuf::Free(head);
+      }
+      head = next;
+    }
+  }
+
+  MsgBuf* buf = c.local;
+  if (buf != nullptr)
+  {
+    c.local = buf->m_next;
+    --c.localCount;
+    buf->m_refs.store(1, std::memory_order_relaxed);
+  }
+  else
+  {
+    buf = MsgBuf::Allocate(CLASS_SIZE[cls]);
+    buf->m_pool = this;
+    buf->m_class = static_cast<uint8_t>(cls);
+  }
+
+  buf->m_size = 0;
+  buf->m_next = nullptr;
+  m_refs.fetch_add(1, std::memory_order_relaxed);
+  return buf;
+}
+
+/// <summary>
+/// Returns a buffer the loop acquired but never shared (e.g. recv hit EAGAIN).
+/// </summary>
+void BufPool::Giveback(MsgBuf* buf)
+{
+  SizeClass& c = m_classes[buf->m_class];
+  if (c.localCount < MAX_FREE)
+  {
+    buf->m_next = c.local;
+    c.local = buf;
+    ++c.localCount;
+  }
+  else
+  {
+    MsgBuf::Free(buf);
+  }
+
+  Unref();
+}
+
+void BufPool::Recycle(MsgBuf* buf)
+{
+  std::atomic<MsgBuf*>& head = m_classes[buf->m_class].returned;
+
+  buf->m_next = head.load(std::memory_order_relaxed);
+  while (!head.compare_exchange_weak(buf->m_next, buf,
+    std::memory_order_release, std::memory_order_relaxed)) {}
+
+  Unref();
+}
+
+size_t BufPool::NextClass(size_t cls, size_t filled)
+{
+  // Filled up: sender streams, go bigger
+  if (filled == CLASS_SIZE[cls] && cls + 1 < CLASS_COUNT)
+    return cls + 1;
+
+  // Would have fit in half of the smaller class: go smaller
+  if (cls > 0 && filled <= CLASS_SIZE[cls - 1] / 2)
+    return cls - 1;
+
+  return cls;
+}
+
+void BufPool::Unref()
+{
+  if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    delete this;
+  }
+}
+
+void BufPool::FreeList(MsgBuf* head)
+{
+  while (head != nullptr)
+  {
+    MsgBuf* next = head->m_next;
+    MsgBuf::Free(head);
+    head = next;
+  }
+}
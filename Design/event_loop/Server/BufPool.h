@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class MsgBuf;
+
+/// <summary>
+/// Per-loop pool of receive buffers in a few size classes. The loop thread takes
+/// a buffer, recv()s straight into it and shares it as the broadcast payload.
+/// Whoever drops the last reference, on any loop, pushes it onto the class's
+/// lock-free return list, which the owner drains when its local free list runs dry.
+/// The pool outlives its loop until the last buffer out has come back.
+/// </summary>
+class BufPool
+{
+public:
+  static constexpr size_t CLASS_COUNT = 3;
+  static constexpr size_t CLASS_SIZE[CLASS_COUNT] = { 4 * 1024, 16 * 1024, 64 * 1024 };
+  static constexpr size_t MAX_FREE = 256; // cached buffers per class, the rest is freed
+
+  static BufPool* Create() { return new BufPool(); }
+
+  // Owner is gone, pool deletes itself after the last buffer comes back
+  void Detach() { Unref(); }
+
+  // Loop thread only
+  MsgBuf* Acquire(size_t cls);
+  void Giveback(MsgBuf* buf);
+
+  // Any thread, called by MsgBuf::Release()
+  void Recycle(MsgBuf* buf);
+
+  // Class for the next recv given how much of the last buffer was filled
+  static size_t NextClass(size_t cls, size_t filled);
+
+private:
+  BufPool() = default;
+  ~BufPool();
+
+  void Unref();
+  static void FreeList(MsgBuf* head);
+
+private:
+  struct SizeClass
+  {
+    MsgBuf* local = nullptr;   // owner only
+    size_t localCount = 0;
+    alignas(64) std::atomic<MsgBuf*> returned{nullptr}; // pushed by any thread
+  };
+
+  SizeClass m_classes[CLASS_COUNT];
+
+  // Owner's reference plus one per buffer out of the pool
+  std::atomic<size_t> m_refs{1};
+};
@@ -1,464 +1,421 @@
 #include "ChatServer.h"
-#include "ClientSession.h"
+#include "EventLoop.h"
+#include "UringLoop.h"
+#include "SharedLoop.h"
+#include "SocketUtils.h"
 
 #include <iostream>
-#include <algorithm>
 #include <vector>
 #include <cstring>
+#include <chrono>
+#include <fstream>
 
 #include <sys/socket.h> // socket(), bind(), connect(), listen(), accept()
-#include <unistd.h>     // close()
-#include <netinet/in.h> // sockaddr_in, htons, htonl
-#include <arpa/inet.h>  // inet_ntop()
 #include <netdb.h>      // getaddrinfo(), freeaddrinfo()
-#include <fcntl.h> // fcntl()
+#include <unistd.h>     // sysconf()
 
 using std::cout;
 using std::cerr;
 
 constexpr int MAX_LISTEN = 64; // backlog (Num of clients)
-constexpr int MAX_EVENTS = 1024;
 
 //
 // === UTILS ===
 //
 
 /// <summary>
-/// Safely closes a socket and sets it to INVALID_SOCKET.
+/// Resident set size of the process in bytes, 0 if unknown.
 /// </summary>
-/// <param name="s">Reference to a socket handle.</param>
-static void SafeCloseSocket(int& socketfd)
+static size_t ReadRssBytes()
 {
-  if (socketfd != -1) 
-  {
-    close(socketfd);
-    socketfd = -1;
-  }
-}
-
-/// <summary>
-/// Sets file descriptor to non-blocking mode.
-/// </summary>
-static bool SetNonBlocking(int& sfd)
-{
-    int flags = fcntl(sfd, F_GETFL, 0);
-    if (flags == -1)
-    {
-      return false;
-    }
-
-    if (fcntl(sfd, F_SETFL, flags | O_NONBLOCK) == -1)
-    {
-      return false;
-    }
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0;
+  size_t resident = 0;
+  if (!(statm >> pages >> resident))
+    return 0;
 
-    return true;
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
 }
 
-/// <summary>
-/// prints a sockaddr (IPv4/IPv6) as "ip:port".
-/// </summary>
-/// <param name="addr">Pointer to a generic sockaddr.</param>
-static void PrintSockaddr(const sockaddr* addr)
-{
-  char ipStr[INET6_ADDRSTRLEN] = {};
-  int port = 0;
+//
+// === ChatServer functions ===
+//
 
-  if (addr->sa_family == AF_INET) // IPv4
+ChatServer::ChatServer(const std::vector<std::string>& ips, const std::string& port,
+  const ServerOptions& opts)
+  : m_opts(opts), m_port(port), m_ips(ips)
+{
+  // 0 means one loop per core
+  if (m_opts.loops == 0)
   {
-    const sockaddr_in* ipv4 = reinterpret_cast<const sockaddr_in*>(addr);
-    if (inet_ntop(AF_INET, &(ipv4->sin_addr), ipStr, sizeof(ipStr)))
-    {
-      port = ntohs(ipv4->sin_port);
-    }
+    m_opts.loops = std::thread::hardware_concurrency();
   }
-  else if (addr->sa_family == AF_INET6) // IPv6
+
+  if (m_opts.loops == 0)
   {
-    const sockaddr_in6* ipv6 = reinterpret_cast<const sockaddr_in6*>(addr);
-    if (inet_ntop(AF_INET6, &(ipv6->sin6_addr), ipStr, sizeof(ipStr)))
-    {
-      port = ntohs(ipv6->sin6_port);
-    }
+    m_opts.loops = 1;
   }
-  else
+
+  // Worker pool is a single loop whose set every worker waits on
+  if (m_opts.workers > 0)
   {
-    cerr << "Unknown address family\n";
+    m_opts.loops = 1;
   }
-
-  cout << ipStr << ":" << port << "\n";
 }
 
-//
-// === ChatServer functions ===
-//
-
-ChatServer::ChatServer(const std::vector<std::string>& ips, const std::string& port)
-  : m_port(port), m_ips(ips) {}
-
 ChatServer::~ChatServer()
 {
   Stop();
+  JoinLoops();
+  m_loops.clear();
 }
 
 /// <summary>
-/// Starts Winsock, creates listening sockets for all IPs, switches them to non-blocking mode,
-/// and enters the select() loop. This function blocks until Stop() is invoked or an error occurs.
+/// Creates one event loop per thread, each with its own SO_REUSEPORT listening sockets,
+/// and runs them. This function blocks until Stop() is invoked or any loop fails.
 /// </summary>
 void ChatServer::Start()
 {
-  cout << "Strarting server...\n";
-
-  // Open non-blocking listening sockets for all configured IPs.
-  for (const auto& ip : m_ips)
+  if (m_opts.workers > 0)
   {
-    int sfd = CreateListenSocket(ip);
-    if (sfd != -1)
-    {
-      if (SetNonBlocking(sfd))
-      {
-        m_listenSockets.insert(sfd);
-      }
-    }
+    cout << "Strarting server with " << m_opts.workers << " worker(s) on a shared epoll set...\n";
   }
-
-  if (m_listenSockets.empty())
+  else
   {
-    cerr << "Failed to create listening sockets\n";
-    return;
+    cout << "Strarting server with " << m_opts.loops << " loop(s), backend: "
+      << (m_opts.backend == Backend::IoUring ? "io_uring" : "epoll") << "...\n";
   }
 
-  // Init epoll
-  m_epoll = epoll_create1(EPOLL_CLOEXEC);
-  if (m_epoll < 0)
+  if (!CreateLoops())
   {
-    perror("epoll_create1");
-    Stop();
+    m_loops.clear();
     return;
   }
 
-  // Fill epoll with listeners
-  for (const auto& lsfd : m_listenSockets)
+  m_running.store(true, std::memory_order_release);
+
+  for (auto& loop : m_loops)
   {
-    AddListenToEpoll(lsfd);
+    LoopBase* pLoop = loop.get();
+    for (size_t w = 0; w < pLoop->Workers(); ++w)
+    {
+      m_threads.emplace_back([this, pLoop]
+        {
+          pLoop->Run();
+
+          // One loop is down, bring down the others as well
+          Stop();
+        });
+    }
   }
 
-  m_running = true;
-  RunLoop();
+  ReportStats();
+  JoinLoops();
 
-  // Ensure cleanup when the loop exits.
-  Stop();
+  // Ensure cleanup when the loops exit.
+  m_loops.clear();
 }
 
 /// <summary>
-/// Stops the server, closes all sockets and client sessions, and calls WSACleanup().
-/// The method is idempotent and safe to call multiple times.
+/// Asks every loop to stop. Safe to call from any thread, including loop threads,
+/// and multiple times. Sessions and sockets are released once loops are joined.
 /// </summary>
 void ChatServer::Stop()
 {
-  if (!m_running && m_listenSockets.empty() && m_clients.empty())
-  {
-    return;
-  }
-
-  // Close clients
-  for (auto& kv : m_clients)
   {
-    if (kv.second)
-    {
-      kv.second->Stop();
-    }
+    std::lock_guard<std::mutex> lg(m_statsMutex);
+    m_running.store(false, std::memory_order_release);
   }
-  m_clients.clear();
+  m_statsCV.notify_all();
 
-  // Close listeners
-  for (auto s : m_listenSockets)
+  for (auto& loop : m_loops)
   {
-    SafeCloseSocket(s);
-  }
-  m_listenSockets.clear();
-
-  if (m_epoll != -1) 
-  { 
-    close(m_epoll); 
-    m_epoll = -1; 
+    loop->Stop();
   }
-
-  m_running = false;
 }
 
 /// <summary>
-/// Creates, binds and listens on a socket for the given IP address string.
-/// Returns -1 on failure.
+/// Creates m_opts.loops loops with a listening socket per configured IP for each one.
+/// The kernel balances incoming connections between them via SO_REUSEPORT.
 /// </summary>
-/// <param name="ip">IP address to bind (v4 or v6).</param>
-int ChatServer::CreateListenSocket(const std::string& ip)
+bool ChatServer::CreateLoops()
 {
-  int retVal = -1; // Socket fd
-
-  struct addrinfo hints;
-  memset(&hints, 0, sizeof(hints));
-  hints.ai_family = AF_UNSPEC;
-  hints.ai_socktype = SOCK_STREAM;
-  hints.ai_protocol = IPPROTO_TCP;
-  hints.ai_flags = AI_PASSIVE;
-
-  addrinfo* result = nullptr;
-  if (getaddrinfo(ip.c_str(), m_port.c_str(), &hints, &result) != 0)
+  for (size_t i = 0; i < m_opts.loops; ++i)
   {
-    return -1;
-  }
+    std::vector<int> listenSockets;
+    for (const auto& ip : m_ips)
+    {
+      int sfd = CreateListenSocket(ip);
+      if (sfd == -1)
+      {
+        continue;
+      }
 
-  for (addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next)
-  {
-    int sfd = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
-    if (sfd == -1) continue;
+      if (!SetNonBlocking(sfd))
+      {
+        SafeCloseSocket(sfd);
+        continue;
+      }
 
-    if (bind(sfd, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen)) == -1)
-    {
-      SafeCloseSocket(sfd);
-      continue;
+      listenSockets.push_back(sfd);
     }
 
-    if (listen(sfd, MAX_LISTEN) == -1)
+    if (listenSockets.empty())
     {
-      SafeCloseSocket(sfd);
-      continue;
+      cerr << "Failed to create listening sockets\n";
+      return false;
     }
 
-    cout << "Server listening on: ";
-    PrintSockaddr(ptr->ai_addr);
+    std::unique_ptr<LoopBase> loop;
+    if (m_opts.workers > 0)
+      loop = std::make_unique<SharedLoop>(this, i);
+    else if (m_opts.backend == Backend::IoUring)
+      loop = std::make_unique<UringLoop>(this, i);
+    else
+      loop = std::make_unique<EventLoop>(this, i);
 
-    retVal = sfd;
-    break;
+    if (!loop->Init(listenSockets))
+    {
+      return false;
+    }
+
+    m_loops.push_back(std::move(loop));
   }
 
-  freeaddrinfo(result);
-  return retVal;
+  return true;
 }
 
-void ChatServer::AddListenToEpoll(const int& lsocket)
+void ChatServer::JoinLoops()
 {
-  epoll_event ev{};
-  ev.events = EPOLLIN; // LT is OK for listen sockets
-  ev.data.fd = lsocket;
-  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, lsocket, &ev) < 0)
+  for (auto& th : m_threads)
   {
-    perror("epoll_ctl ADD listen");
+    if (th.joinable())
+    {
+      th.join();
+    }
   }
+  m_threads.clear();
 }
 
-/// <summary>Top-level select() loop broken into clear steps.</summary>
-void ChatServer::RunLoop()
+/// <summary>
+/// Prints per-second rates of the loops' counters every statsSec seconds
+/// until Stop(). Returns immediately if stats are off.
+/// </summary>
+void ChatServer::ReportStats()
 {
-   std::vector<epoll_event> events(MAX_EVENTS);
+  if (m_opts.statsSec == 0)
+    return;
 
-  while (m_running)
+  const auto period = std::chrono::seconds(m_opts.statsSec);
+  uint64_t lastEpollCtl = 0;
+  uint64_t lastEpollWaits = 0;
+  uint64_t lastEvents = 0;
+  uint64_t lastAccepts = 0;
+  uint64_t lastMsgsIn = 0;
+  uint64_t lastSendCalls = 0;
+  uint64_t lastReadYields = 0;
+  uint64_t lastRelayed = 0;
+  uint64_t lastZcSends = 0;
+  uint64_t lastZcCopied = 0;
+  uint64_t lastAllocs = MsgBuf::AllocCount();
+
+  std::unique_lock<std::mutex> lock(m_statsMutex);
+  while (m_running.load(std::memory_order_acquire))
   {
-    int n = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), -1);
-    if (n < 0)
-    { // dont need to continue on 0, cos it is impossible to return such.
-      if (errno == EINTR) continue; // Interrupted. Retry.
-      perror("epoll_wait");
-      break;
+    m_statsCV.wait_for(lock, period, [&]
+    {
+      return !m_running.load(std::memory_order_acquire);
+    });
+
+    uint64_t epollCtl = 0;
+    uint64_t epollWaits = 0;
+    uint64_t events = 0;
+    uint64_t accepts = 0;
+    uint64_t closes = 0;
+    uint64_t msgsIn = 0;
+    uint64_t sendCalls = 0;
+    uint64_t readYields = 0;
+    uint64_t relayed = 0;
+    uint64_t zcSends = 0;
+    uint64_t zcCopied = 0;
+    uint64_t txDropNewest = 0;
+    uint64_t txDropOldest = 0;
+    uint64_t txDisconnects = 0;
+    uint64_t queuedBytes = 0;
+    uint64_t pausedReaders = 0;
+    uint64_t readPauses = 0;
+    for (auto& loop : m_loops)
+    {
+      const LoopStats& st = loop->GetStats();
+      epollCtl += st.epollCtl.load(std::memory_order_relaxed);
+      epollWaits += st.epollWaits.load(std::memory_order_relaxed);
+      events += st.events.load(std::memory_order_relaxed);
+      accepts += st.accepts.load(std::memory_order_relaxed);
+      closes += st.closes.load(std::memory_order_relaxed);
+      msgsIn += st.msgsIn.load(std::memory_order_relaxed);
+      sendCalls += st.sendCalls.load(std::memory_order_relaxed);
+      readYields += st.readYields.load(std::memory_order_relaxed);
+      relayed += st.relayedBytes.load(std::memory_order_relaxed);
+      zcSends += st.zeroCopySends.load(std::memory_order_relaxed);
+      zcCopied += st.zeroCopyCopied.load(std::memory_order_relaxed);
+      txDropNewest += st.txDropNewest.load(std::memory_order_relaxed);
+      txDropOldest += st.txDropOldest.load(std::memory_order_relaxed);
+      txDisconnects += st.txDisconnects.load(std::memory_order_relaxed);
+      queuedBytes += st.queuedBytes.load(std::memory_order_relaxed);
+      pausedReaders += st.pausedReaders.load(std::memory_order_relaxed);
+      readPauses += st.readPauses.load(std::memory_order_relaxed);
     }
 
-    for (int i = 0; i < n; ++i)
-    {
-      int fd = events[i].data.fd;
-      uint32_t ev = events[i].events;
+    cout << "[stats] events/s: " << (events - lastEvents) / m_opts.statsSec
+      << " epoll_ctl/s: " << (epollCtl - lastEpollCtl) / m_opts.statsSec;
 
-      // Accept first for ET
-      if (m_listenSockets.count(fd) > 0)
-      {
-        HandleListeners(fd, ev);
-        continue;
-      }
-
-      HandleClients(fd, ev);
+    // epoll_wait + epoll_ctl per dispatched event, the cost the epoll mode trades off
+    if (events > lastEvents)
+    {
+      double perEvent = static_cast<double>((epollCtl - lastEpollCtl) + (epollWaits - lastEpollWaits)) /
+        static_cast<double>(events - lastEvents);
+      cout << " epoll syscalls/event: " << perEvent;
     }
-  }
-}
 
-//
-// === Handlers ===
-//
+    cout
+      << " accepts/s: " << (accepts - lastAccepts) / m_opts.statsSec
+      << " msgs/s: " << (msgsIn - lastMsgsIn) / m_opts.statsSec
+      << " send syscalls/s: " << (sendCalls - lastSendCalls) / m_opts.statsSec
+      << " read yields/s: " << (readYields - lastReadYields) / m_opts.statsSec;
 
-void ChatServer::HandleListeners(int& sfd, uint32_t& event)
-{
-  if (event & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
-  {
-    cerr << "Listener fd = " << sfd << "error/hup/nval\n";
-    m_running = false;
-    return;
-  }
+    uint64_t allocs = MsgBuf::AllocCount();
+    cout << " payload allocs/s: " << (allocs - lastAllocs) / m_opts.statsSec;
+    lastAllocs = allocs;
 
-  if (event & EPOLLIN) 
-  {
-    AcceptAll(sfd);  // drain accept() to EAGAIN
-  }
-}
-
-void ChatServer::HandleClients(int& sfd, uint32_t& event)
-{
-  // Errors / hangups first
-  if (event & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
-  {
-    CloseClient(sfd);
-    return;
-  }
+    // Memory density: whole process RSS over open sessions
+    uint64_t sessions = accepts - closes;
+    cout << " sessions: " << sessions;
+    if (sessions > 0)
+    {
+      cout << " rss/session: " << ReadRssBytes() / sessions << " B";
+    }
 
-  auto it = m_clients.find(sfd);
-  if (it == m_clients.end()) return;
-  auto& sess = it->second;
+    if (m_opts.spliceRelay)
+    {
+      cout << " relayed KB/s: " << (relayed - lastRelayed) / 1024 / m_opts.statsSec;
+    }
 
-  // Readable
-  if (event & EPOLLIN)
-  {
-    if (!sess->Read())
+    if (m_opts.zeroCopyMin > 0)
     {
-      CloseClient(sfd);
-      return;
+      cout << " zerocopy/s: " << (zcSends - lastZcSends) / m_opts.statsSec
+        << " (copied: " << (zcCopied - lastZcCopied) / m_opts.statsSec << ")";
     }
-  }
 
-  // Writable
-  if (event & EPOLLOUT)
-  {
-    if (!sess->Write())
+    cout << " queued: " << queuedBytes / 1024 << " KB";
+    if (m_opts.backpressure > 0)
     {
-      CloseClient(sfd);
-      return;
+      cout << " paused readers: " << pausedReaders << " (pauses: " << readPauses << ")";
     }
 
-    // If queue is empty now — drop EPOLLOUT to avoid busy wakeups
-    ModClientWritable(sfd);
+    // Slow readers, totals since start
+    if (txDropNewest + txDropOldest + txDisconnects > 0)
+    {
+      cout << " tx dropped newest: " << txDropNewest
+        << " oldest: " << txDropOldest
+        << " disconnects: " << txDisconnects;
+    }
+    cout << "\n";
+    lastEpollCtl = epollCtl;
+    lastEpollWaits = epollWaits;
+    lastEvents = events;
+    lastAccepts = accepts;
+    lastMsgsIn = msgsIn;
+    lastSendCalls = sendCalls;
+    lastReadYields = readYields;
+    lastRelayed = relayed;
+    lastZcSends = zcSends;
+    lastZcCopied = zcCopied;
   }
 }
 
-//
-// === Handlers' helpers ===
-//
-
-void ChatServer::AddClientToEpoll(const int& clsocket)
+/// <summary>
+/// Creates, binds and listens on a SO_REUSEPORT socket for the given IP address string.
+/// Returns -1 on failure.
+/// </summary>
+/// <param name="ip">IP address to bind (v4 or v6).</param>
+int ChatServer::CreateListenSocket(const std::string& ip)
 {
-  epoll_event ev;
-  memset(&ev, 0, sizeof(ev));
-  ev.data.fd = clsocket;
-  ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | EPOLLONESHOT; // ET for clients with ONESHOT which freezes fd
-
-  auto it = m_clients.find(clsocket);
-  if (it == m_clients.end())
-  {
-    return;
-  }
+  int retVal = -1; // Socket fd
 
-  if (it->second->IsWantSend())
-  {
-   ev.events |= EPOLLOUT;
-  }
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+  hints.ai_flags = AI_PASSIVE;
 
-  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, clsocket, &ev) < 0)
+  addrinfo* result = nullptr;
+  if (getaddrinfo(ip.c_str(), m_port.c_str(), &hints, &result) != 0)
   {
-    perror("epoll_ctl ADD client");
+    return -1;
   }
-}
 
-void ChatServer::AcceptAll(int& fd)
-{
-  while (true)
+  for (addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next)
   {
-    int cs = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK);
+    int sfd = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
+    if (sfd == -1) continue;
 
-    if (cs == -1)
+    // Every loop binds the same ip:port, kernel spreads accepts between them
+    int on = 1;
+    if (setsockopt(sfd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1)
     {
-      if (errno == EAGAIN || errno == EWOULDBLOCK)
-      {
-        // No more clients
-        break;
-      }
-
-      std::perror("accept4");
-      break;
+      SafeCloseSocket(sfd);
+      continue;
     }
 
-    // Optional greeting
-    static const char* hello = "Welcome to the chat!\n";
-    send(cs, hello, strlen(hello), MSG_NOSIGNAL);
-
-    // Save in clients, add to epoll
-    m_clients.emplace(cs, std::make_unique<ClientSession>(cs, this));
-    AddClientToEpoll(cs);
-
-    // Log peer address
-    sockaddr_storage ss;
-    socklen_t addLen = sizeof(addr);
-    memset(&addr, 0, addLen);
-
-    if (getpeername(cs, reinterpret_cast<sockaddr*>(&ss), &slen) == 0)
+    if (bind(sfd, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen)) == -1)
     {
-      cout << "Client connected: ";
-      PrintSockaddr(&addr);
+      SafeCloseSocket(sfd);
+      continue;
     }
-    else
+
+    if (listen(sfd, MAX_LISTEN) == -1)
     {
-      std::perror("getpeername");
+      SafeCloseSocket(sfd);
+      continue;
     }
-  }
-}
 
-void ChatServer::ModClientWritable(int fd)
-{
-  auto it = m_clients.find(fd);
-  if (it == m_clients.end()) return;
+    cout << "Server listening on: ";
+    PrintSockaddr(ptr->ai_addr);
 
-  // Base mask for clients under ET
-  uint32_t mask = EPOLLIN | EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
-  if (it->second && it->second->IsWantSend())
-  {
-    mask |= EPOLLOUT;
+    retVal = sfd;
+    break;
   }
 
-  epoll_event ev{};
-  ev.data.fd = fd;
-  ev.events  = mask;
-
-  if (epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &ev) < 0)
-  {
-    perror("epoll_ctl MOD client");
-  }
+  freeaddrinfo(result);
+  return retVal;
 }
 
-void ChatServer::CloseClient(int& sfd)
+/// <summary>
+/// Hands a message received by one loop to every other loop's inbox.
+/// Called from the origin loop's thread.
+/// </summary>
+void ChatServer::BroadcastMsg(const MsgRef& msg, LoopBase* pOrigin)
 {
-  auto it = m_clients.find(sfd);
-  if (it != m_clients.end())
+  for (auto& loop : m_loops)
   {
-    if (it->second)
+    if (loop.get() != pOrigin)
     {
-      it->second->Stop();
+      pOrigin->ForwardMsg(loop.get(), msg);
     }
-    m_clients.erase(it);
   }
-
-  // remove socket from epoll just incase
-  if (m_epoll != -1)
-    epoll_ctl(m_epoll, EPOLL_CTL_DEL, sfd, nullptr);
-
-  SafeCloseSocket(sfd);
 }
 
-void ChatServer::BroadcastMsg(const std::string& msg, ClientSession* pSender)
+/// <summary>
+/// Server-wide outbound gauge: bytes queued in every loop's sessions as each loop
+/// last published it. Any thread.
+/// </summary>
+uint64_t ChatServer::QueuedBytes() const
 {
-  for (auto& cli : m_clients)
+  uint64_t total = 0;
+  for (const auto& loop : m_loops)
   {
-    const auto& s = cli.second;
-    if (s && s.get() != pSender)
-    {
-      s->PostSend(msg);
-      // Ensure we get notified to flush
-      ModClientWritable(cli.first);
-    }
+    total += loop->GetStats().queuedBytes.load(std::memory_order_relaxed);
   }
-
-  cout << "Message broadcasted:" << msg << "\n";
+  return total;
 }
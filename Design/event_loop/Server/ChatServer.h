@@ -3,47 +3,53 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <unordered_map>
-#include <unordered_set>
-
-#include <sys/epoll.h>   // epoll()
-
-class ClientSession;
-
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include "ServerOptions.h"
+
+class LoopBase;
+class MsgRef;
+
+/// <summary>
+/// Multi-reactor chat server. Runs one loop per thread (epoll EventLoop or io_uring
+/// UringLoop), each loop owns its SO_REUSEPORT listeners and shard of client sessions.
+/// With opts.workers the single SharedLoop is run by that many threads instead.
+/// </summary>
 class ChatServer
 {
 public:
-  ChatServer(const std::vector<std::string>& ips, const std::string& port);
+  ChatServer(const std::vector<std::string>& ips, const std::string& port,
+    const ServerOptions& opts = ServerOptions());
   ~ChatServer();
 
   void Start();
   void Stop();
 
-  void BroadcastMsg(const std::string& msg, ClientSession* pSender);
+  void BroadcastMsg(const MsgRef& msg, LoopBase* pOrigin);
+  LoopBase* GetLoop(size_t id) { return m_loops[id].get(); }
+  const ServerOptions& GetOptions() const { return m_opts; }
+  uint64_t QueuedBytes() const;
 
 private:
   int CreateListenSocket(const std::string& ip);
-  void RunLoop();
-
-  void HandleListeners(int& sfd, uint32_t& event);
-  void HandleClients(int& sfd, uint32_t& event);
-
-  void AddListenToEpoll(const int& lsocket);
-  void AddClientToEpoll(const int& clsocket);
-
-  void AcceptAll(int& fd);
-  void CloseClient(int& sfd);
-  void ModClientWritable(int fd);
-  bool ReadClient(int& sfd);
-  bool WriteClient(int& sfd);
-
+  bool CreateLoops();
+  void JoinLoops();
+  void ReportStats();
 
 private:
-  bool m_running = false;
-  int m_epoll = -1;
+  std::atomic<bool> m_running{false};
+  ServerOptions m_opts;
   std::string m_port;
   std::vector<std::string> m_ips;
 
-  std::unordered_set<int> m_listenSockets;
-  std::unordered_map<int, std::unique_ptr<ClientSession>> m_clients;
+  std::vector<std::unique_ptr<LoopBase>> m_loops;
+  std::vector<std::thread> m_threads;
+
+  // Wakes the stats reporter on Stop()
+  std::mutex m_statsMutex;
+  std::condition_variable m_statsCV;
 };
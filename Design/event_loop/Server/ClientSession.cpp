@@ -1,41 +1,75 @@
 #include "ClientSession.h"
-#include "ChatServer.h"
+#include "EventLoop.h"
+#include "BufPool.h"
 
 #include <sys/socket.h> // socket(), bind(), connect(), listen(), accept()
+#include <sys/uio.h>    // iovec
+#include <netinet/in.h> // IP_RECVERR
+#include <linux/errqueue.h> // sock_extended_err
 #include <unistd.h>     // close()
+#include <climits>      // IOV_MAX
+#include <cstring>
+#include <cerrno>
+#include <utility>
 
 constexpr int RECV_BUF = 4096;
+constexpr size_t SEND_IOV_MAX = IOV_MAX; // msgs gathered per sendmsg()
 
 //
 // === ClientSession functions ===
 //
 
-ClientSession::ClientSession(int& sfd, ChatServer* server)
-  : m_socket(sfd), m_server(server) {}
+ClientSession::ClientSession(int& sfd, EventLoop* loop)
+{
+  const ServerOptions& opts = loop->GetOptions();
+
+  m_hot.socket = sfd;
+  m_hot.loop = loop;
+  m_hot.inlineSend = opts.inlineSend && !opts.uringSend;
+  m_hot.spliceRelay = opts.spliceRelay;
+
+  // io_uring sends keep copying, zero-copy applies to Write()
+  if (opts.zeroCopyMin > 0 && !opts.uringSend)
+  {
+    int one = 1;
+    m_hot.zeroCopy = setsockopt(m_hot.socket, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+  }
+}
 
 ClientSession::~ClientSession()
 {
+  // Zero-copy payloads are released with the session. An abortive close purges the
+  // socket's write queue inside close(), so the kernel is done with them first.
+  if (m_zcPending && m_hot.socket != -1)
+  {
+    linger lg{ 1, 0 };
+    setsockopt(m_hot.socket, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+  }
+
   Stop();
+
+  // Whatever is still queued leaves the loop's outbound gauge
+  SubQueued(m_hot.queuedBytes);
 }
 
 void ClientSession::Stop()
 {
-  if (m_socket != -1)
+  if (m_hot.socket != -1)
   {
     GracefulShutdown();
-    close(m_socket);
-    m_socket = -1;
+    close(m_hot.socket);
+    m_hot.socket = -1;
   }
 }
 
 void ClientSession::GracefulShutdown()
 {
-  shutdown(m_socket, SHUT_WR);
+  shutdown(m_hot.socket, SHUT_WR);
 
   char buf[RECV_BUF];
   while (true)
   {
-    ssize_t bytes = recv(m_socket, buf, static_cast<size_t>(RECV_BUF), 0);
+    ssize_t bytes = recv(m_hot.socket, buf, static_cast<size_t>(RECV_BUF), 0);
 
     // peer closed connection
     if (bytes == 0)
@@ -57,11 +91,32 @@ void ClientSession::GracefulShutdown()
 
 bool ClientSession::Read()
 {
-  char buf[RECV_BUF];
+  m_hot.readPending = false;
+
+  if (m_hot.spliceRelay)
+  {
+    return ReadRelay();
+  }
+
+  // Backpressure: the rest stays in the socket, TCP pushes back on the publisher
+  if (m_hot.readPaused)
+  {
+    return true;
+  }
+
+  BufPool& pool = m_hot.loop->GetBufPool();
+  size_t budget = m_hot.loop->GetOptions().readBudget;
+  size_t total = 0;
   while (true)
   {
+    // recv straight into the payload every recipient will share
+    MsgBuf* buf = pool.Acquire(m_hot.recvClass);
+    ssize_t bytes = recv(m_hot.socket, buf->MutableData(), buf->Capacity(), 0);
 
-    ssize_t bytes = recv(m_socket, buf, static_cast<size_t>(RECV_BUF), 0);
+    if (bytes <= 0)
+    {
+      pool.Giveback(buf);
+    }
 
     // peer closed connection
     if (bytes == 0) return false;
@@ -79,17 +134,112 @@ bool ClientSession::Read()
       return false;
     }
 
-    std::string msg(buf, buf + bytes);
-    m_server->BroadcastMsg(msg, this);
+    buf->SetSize(static_cast<size_t>(bytes));
+    m_hot.recvClass = BufPool::NextClass(m_hot.recvClass, static_cast<size_t>(bytes));
+
+    MsgRef msg(buf);
+    m_hot.loop->BroadcastMsg(msg, this);
+
+    if (!m_hot.loop->AdmitPublish(this, static_cast<size_t>(bytes)))
+    {
+      return true;
+    }
+
+    // Budget spent, the loop comes back after serving the rest of the batch
+    total += static_cast<size_t>(bytes);
+    if (budget > 0 && total >= budget)
+    {
+      YieldRead();
+      return true;
+    }
+  }
+}
+
+/// <summary>
+/// Read() for splice relay mode: the loop moves the bytes to recipients kernel-side.
+/// </summary>
+bool ClientSession::ReadRelay()
+{
+  size_t budget = m_hot.loop->GetOptions().readBudget;
+  size_t total = 0;
+  while (!m_hot.readPaused)
+  {
+    ssize_t bytes = m_hot.loop->RelayFrom(m_hot.socket, this);
+
+    // peer closed connection
+    if (bytes == 0) return false;
+
+    // Error occured
+    if (bytes < 0)
+    {
+      // Stream of recv fully read
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        return true;
+      }
+
+      std::perror("splice");
+      return false;
+    }
+
+    m_hot.loop->AdmitPublish(this, static_cast<size_t>(bytes));
+
+    total += static_cast<size_t>(bytes);
+    if (budget > 0 && total >= budget)
+    {
+      YieldRead();
+      return true;
+    }
   }
+
+  return true;
+}
+
+/// <summary>
+/// Gives up the rest of this turn with data possibly left in the socket.
+/// No new edge will come for it, so the loop keeps the session on its ready list.
+/// </summary>
+void ClientSession::YieldRead()
+{
+  m_hot.readPending = true;
+  m_hot.loop->GetStats().readYields.fetch_add(1, std::memory_order_relaxed);
 }
 
 bool ClientSession::Write()
 {
-  while (!m_sendQueue.empty())
+  iovec iov[SEND_IOV_MAX];
+
+  while (m_hot.queued > 0)
   {
-    std::string& msg = m_sendQueue.front();
-    ssize_t bytes = send(m_socket, msg.c_str(), msg.size(), MSG_NOSIGNAL);
+    // Large head goes alone with MSG_ZEROCOPY, small ones are gathered
+    // up to the next large one as much as one sendmsg() takes
+    bool zc = UseZeroCopy(m_sendQueue->front());
+    size_t cnt = 0;
+    size_t total = 0;
+    for (auto it = m_sendQueue->begin(); it != m_sendQueue->end() && cnt < SEND_IOV_MAX; ++it, ++cnt)
+    {
+      if (cnt > 0 && (zc || UseZeroCopy(*it)))
+        break;
+
+      size_t offset = (cnt == 0) ? m_hot.sendOffset : 0;
+      iov[cnt].iov_base = const_cast<char*>(it->Data() + offset);
+      iov[cnt].iov_len = it->Size() - offset;
+      total += iov[cnt].iov_len;
+    }
+
+    msghdr mh{};
+    mh.msg_iov = iov;
+    mh.msg_iovlen = cnt;
+    ssize_t bytes = sendmsg(m_hot.socket, &mh, MSG_NOSIGNAL | (zc ? MSG_ZEROCOPY : 0));
+    m_hot.loop->GetStats().sendCalls.fetch_add(1, std::memory_order_relaxed);
+
+    // Out of memory for pinning pages, this one is copied
+    if (bytes < 0 && zc && errno == ENOBUFS)
+    {
+      zc = false;
+      bytes = sendmsg(m_hot.socket, &mh, MSG_NOSIGNAL);
+      m_hot.loop->GetStats().sendCalls.fetch_add(1, std::memory_order_relaxed);
+    }
 
     // peer closed connection
     if (bytes == 0) return false;
@@ -100,31 +250,384 @@ bool ClientSession::Write()
       // Stream of recv fully read or try again later
       if (errno == EAGAIN || errno == EWOULDBLOCK)
       {
+        m_hot.writeBlocked = true;
         return true;
       }
 
-      std::perror("send");
+      std::perror("sendmsg");
       return false;
     }
 
-    // Half part of msg was sent
-    if (bytes < static_cast<ssize_t>(msg.size()))
+    // Kernel now references the payload, keep it alive until the completion
+    if (zc)
     {
-      msg.erase(0, static_cast<size_t>(bytes));
-      return true; // Return for Server to call Write again later
+      if (!m_zcPending)
+      {
+        m_zcPending = std::make_unique<std::deque<ZeroCopyRef>>();
+      }
+      m_zcPending->push_back({ m_zcNextId++, m_sendQueue->front() });
+      m_hot.loop->GetStats().zeroCopySends.fetch_add(1, std::memory_order_relaxed);
     }
 
-    m_sendQueue.pop_front();
+    ConsumeSent(static_cast<size_t>(bytes));
+
+    // Kernel buffer is full
+    if (static_cast<size_t>(bytes) < total)
+    {
+      m_hot.writeBlocked = true;
+      return true; // Return for Server to call Write again later
+    }
   }
 
   // All was read and send queue is free to go
   return true;
 }
 
-void ClientSession::PostSend(const std::string& msg)
+/// <summary>
+/// Pops fully sent messages and moves the offset cursor inside a partially sent one.
+/// </summary>
+void ClientSession::ConsumeSent(size_t bytes)
+{
+  while (bytes > 0 && m_hot.queued > 0)
+  {
+    size_t left = m_sendQueue->front().Size() - m_hot.sendOffset;
+    if (bytes < left)
+    {
+      m_hot.sendOffset += bytes;
+      return;
+    }
+
+    // Drops this session's reference, last recipient frees the payload
+    bytes -= left;
+    SubQueued(m_sendQueue->front().Footprint());
+    m_sendQueue->pop_front();
+    --m_hot.queued;
+    m_hot.sendOffset = 0;
+  }
+
+  // Drained: an idle session owns no queue, the loop keeps it for the next one
+  if (m_hot.queued == 0)
+  {
+    m_hot.loop->GivebackSendQueue(std::move(m_sendQueue));
+  }
+}
+
+/// <summary>
+/// Keeps the session's queued footprint and the loop's outbound gauge in step.
+/// A message is charged in full until its last byte is sent.
+/// </summary>
+void ClientSession::AddQueued(size_t bytes)
 {
-  if (!msg.empty()) 
+  m_hot.queuedBytes += bytes;
+  m_hot.loop->AddQueuedBytes(bytes);
+}
+
+void ClientSession::SubQueued(size_t bytes)
+{
+  m_hot.queuedBytes -= bytes;
+  m_hot.loop->SubQueuedBytes(bytes);
+}
+
+/// <summary>
+/// Applies the send queue bounds to a message of the given footprint about to be queued.
+/// Returns false if it must not be queued.
+/// </summary>
+bool ClientSession::AdmitSend(size_t bytes)
+{
+  const ServerOptions& opts = m_hot.loop->GetOptions();
+  if (opts.txHwm == 0)
+    return true;
+
+  LoopStats& stats = m_hot.loop->GetStats();
+
+  // Hysteresis: once shedding, stay so until the reader has caught up
+  if (m_hot.shedding)
+  {
+    if (m_hot.queuedBytes > opts.txLwm)
+    {
+      stats.txDropNewest.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    m_hot.shedding = false;
+  }
+
+  // An empty queue takes any one message, or one bigger than the HWM would never go out
+  if (m_hot.queuedBytes == 0 || m_hot.queuedBytes + bytes <= opts.txHwm)
+    return true;
+
+  switch (opts.txOverflow)
+  {
+    case TxOverflowMode::DropNewest:
+      m_hot.shedding = true;
+      stats.txDropNewest.fetch_add(1, std::memory_order_relaxed);
+      return false;
+
+    case TxOverflowMode::DropOldest:
+      DropOldest(opts.txLwm > bytes ? opts.txLwm - bytes : 0);
+      if (m_hot.queuedBytes + bytes <= opts.txHwm)
+        return true;
+
+      // Whatever is left is already being sent
+      stats.txDropNewest.fetch_add(1, std::memory_order_relaxed);
+      return false;
+
+    case TxOverflowMode::DisconnectOnOverflow:
+    default:
+      // Closing here would pull the session out from under the fan-out.
+      // The hangup this raises closes it from the loop instead.
+      m_hot.overflowed = true;
+      DropQueue();
+      shutdown(m_hot.socket, SHUT_RDWR);
+      stats.txDisconnects.fetch_add(1, std::memory_order_relaxed);
+      return false;
+  }
+}
+
+/// <summary>
+/// Evicts queued messages from the front until at most target bytes are queued.
+/// The front message stays, the peer may already have its start: it is either
+/// partially sent or the rest of a spliced chunk. Anything an io_uring send covers stays too.
+/// </summary>
+void ClientSession::DropOldest(size_t target)
+{
+  if (m_hot.queued == 0 || m_hot.sendInFlight)
+    return;
+
+  auto first = m_sendQueue->begin() + 1;
+  auto last = first;
+  while (last != m_sendQueue->end() && m_hot.queuedBytes > target)
+  {
+    SubQueued(last->Footprint());
+    ++last;
+  }
+
+  size_t dropped = static_cast<size_t>(last - first);
+  m_sendQueue->erase(first, last);
+  m_hot.queued -= static_cast<uint32_t>(dropped);
+  m_hot.loop->GetStats().txDropOldest.fetch_add(dropped, std::memory_order_relaxed);
+
+  if (m_hot.queued == 0)
+  {
+    m_hot.loop->GivebackSendQueue(std::move(m_sendQueue));
+  }
+}
+
+/// <summary>
+/// Releases everything queued for a session that is being cut off.
+/// An in-flight io_uring send still references the queue, it goes on completion.
+/// </summary>
+void ClientSession::DropQueue()
+{
+  if (m_hot.queued == 0 || m_hot.sendInFlight)
+    return;
+
+  m_hot.loop->GivebackSendQueue(std::move(m_sendQueue));
+  m_hot.queued = 0;
+  SubQueued(m_hot.queuedBytes);
+  m_hot.sendOffset = 0;
+}
+
+bool ClientSession::UseZeroCopy(const MsgRef& msg) const
+{
+  return m_hot.zeroCopy && msg.Size() >= m_hot.loop->GetOptions().zeroCopyMin;
+}
+
+/// <summary>
+/// Drains MSG_ZEROCOPY completions from the error queue and releases the payloads they cover.
+/// Returns false if the socket has a pending error of its own.
+/// </summary>
+bool ClientSession::ReapZeroCopy()
+{
+  char control[CMSG_SPACE(sizeof(sock_extended_err)) + 64];
+
+  while (true)
+  {
+    msghdr mh{};
+    mh.msg_control = control;
+    mh.msg_controllen = sizeof(control);
+
+    if (recvmsg(m_hot.socket, &mh, MSG_ERRQUEUE) < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+
+      std::perror("recvmsg errqueue");
+      return false;
+    }
+
+    for (cmsghdr* cm = CMSG_FIRSTHDR(&mh); cm != nullptr; cm = CMSG_NXTHDR(&mh, cm))
+    {
+      bool recvErr = (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+        (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+      if (!recvErr)
+        continue;
+
+      sock_extended_err ee;
+      memcpy(&ee, CMSG_DATA(cm), sizeof(ee));
+      if (ee.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+        continue;
+
+      // Range [ee_info, ee_data] of sendmsg ids is done
+      if (ee.ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+      {
+        m_hot.loop->GetStats().zeroCopyCopied.fetch_add(ee.ee_data - ee.ee_info + 1, std::memory_order_relaxed);
+      }
+      ReleaseZeroCopy(ee.ee_info, ee.ee_data);
+    }
+  }
+
+  int err = 0;
+  socklen_t len = sizeof(err);
+  if (getsockopt(m_hot.socket, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err != 0)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+/// <summary>
+/// Drops the references held for zero-copy sends with ids in [lo, hi].
+/// Completions come back in order, so this almost always pops from the front.
+/// </summary>
+void ClientSession::ReleaseZeroCopy(uint32_t lo, uint32_t hi)
+{
+  if (!m_zcPending)
+    return;
+
+  uint32_t span = hi - lo;
+  for (auto it = m_zcPending->begin(); it != m_zcPending->end();)
+  {
+    if (it->id - lo <= span)
+      it = m_zcPending->erase(it);
+    else
+      ++it;
+  }
+
+  if (m_zcPending->empty())
+  {
+    m_zcPending.reset();
+  }
+}
+
+/// <summary>
+/// Fills sqe with one sendmsg gathering the head of the send queue.
+/// The gather list and the queued payloads stay put until CompleteSend().
+/// </summary>
+void ClientSession::PrepSend(io_uring_sqe* sqe)
+{
+  if (!m_uringSend)
+  {
+    m_uringSend = std::make_unique<UringSend>();
+  }
+
+  size_t cnt = 0;
+  for (auto it = m_sendQueue->begin(); it != m_sendQueue->end() && cnt < UringSend::IOV; ++it, ++cnt)
+  {
+    size_t offset = (cnt == 0) ? m_hot.sendOffset : 0;
+    m_uringSend->iov[cnt].iov_base = const_cast<char*>(it->Data() + offset);
+    m_uringSend->iov[cnt].iov_len = it->Size() - offset;
+  }
+
+  msghdr& mh = m_uringSend->msg;
+  memset(&mh, 0, sizeof(mh));
+  mh.msg_iov = m_uringSend->iov;
+  mh.msg_iovlen = cnt;
+
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = m_hot.socket;
+  sqe->addr = reinterpret_cast<uint64_t>(&mh);
+  sqe->len = 1;
+  sqe->msg_flags = MSG_NOSIGNAL;
+
+  m_hot.sendInFlight = true;
+}
+
+/// <summary>
+/// Advances the send queue by what the sendmsg completion reports.
+/// Returns false if the connection is broken.
+/// </summary>
+bool ClientSession::CompleteSend(int res)
+{
+  m_hot.sendInFlight = false;
+
+  if (res < 0)
+  {
+    // Nothing went out, the loop resubmits
+    if (res == -EAGAIN || res == -EINTR)
+      return true;
+
+    errno = -res;
+    std::perror("io_uring sendmsg");
+    return false;
+  }
+
+  ConsumeSent(static_cast<size_t>(res));
+  return true;
+}
+
+void ClientSession::PostSend(const MsgRef& msg)
+{
+  if (msg.Size() == 0 || m_hot.overflowed) 
+  {
+    return;
+  }
+
+  // Fast path: nothing queued and the kernel buffer usually has room,
+  // so skip the EPOLLOUT round trip through the loop
+  size_t offset = 0;
+  if (m_hot.inlineSend && m_hot.queued == 0 && !UseZeroCopy(msg))
+  {
+    ssize_t bytes = send(m_hot.socket, msg.Data(), msg.Size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    m_hot.loop->GetStats().sendCalls.fetch_add(1, std::memory_order_relaxed);
+    if (bytes == static_cast<ssize_t>(msg.Size()))
+    {
+      return;
+    }
+
+    // Partial send queues the rest. On EAGAIN or error the whole msg is queued,
+    // errors surface on the next Write() or EPOLLERR.
+    if (bytes > 0)
+    {
+      offset = static_cast<size_t>(bytes);
+    }
+    m_hot.writeBlocked = true;
+  }
+
+  // Once the peer has the start of a message the rest must follow,
+  // refusing it would leave the stream cut mid-message
+  if (offset == 0 && !AdmitSend(msg.Footprint()))
+  {
+    return;
+  }
+
+  Enqueue(msg, offset);
+}
+
+/// <summary>
+/// Queues the unsent rest of a message the peer already has the start of, e.g. a
+/// chunk the splice relay could only partly move. Not subject to the send queue bounds.
+/// </summary>
+void ClientSession::PostRest(const MsgRef& rest)
+{
+  if (rest.Size() == 0 || m_hot.overflowed)
+  {
+    return;
+  }
+
+  Enqueue(rest, 0);
+}
+
+void ClientSession::Enqueue(const MsgRef& msg, size_t offset)
+{
+  if (!m_sendQueue)
+  {
+    m_sendQueue = m_hot.loop->TakeSendQueue();
+  }
+  m_sendQueue->push_back(msg);
+  AddQueued(msg.Footprint());
+  if (++m_hot.queued == 1)
   {
-    m_sendQueue.push_back(msg);
+    m_hot.sendOffset = offset;
   }
 }
@@ -2,33 +2,131 @@
 
 #include <string>
 #include <deque>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
 
-class ChatServer;
+#include <sys/socket.h> // msghdr
+#include <sys/uio.h>    // iovec
+#include <linux/io_uring.h> // io_uring_sqe
+
+#include "MsgBuf.h"
+
+class EventLoop;
 
 /// <summary>
 /// Client session with overlapped recv/send and a send queue.
+/// Laid out hot to cold: what every event and broadcast touches sits in the first
+/// cache line, the send queue and optional send paths live out of line.
 /// </summary>
-class ClientSession
+class alignas(64) ClientSession
 {
 public:
-  ClientSession(int& socket, ChatServer* server);
+  ClientSession(int& socket, EventLoop* loop);
   ~ClientSession();
 
   void Stop();
 
-  bool IsWantSend() { return !m_sendQueue.empty(); }
+  bool IsWantSend() const { return m_hot.queued != 0; }
 
   bool Read();
   bool Write();
 
-  void PostSend(const std::string& msg);
+  // MSG_ZEROCOPY completions arrive on the socket error queue (EPOLLERR)
+  bool IsZeroCopy() const { return m_hot.zeroCopy; }
+  bool ReapZeroCopy();
+  bool HasZeroCopyPending() const { return m_zcPending != nullptr; }
+
+  void PostSend(const MsgRef& msg);
+  void PostRest(const MsgRef& rest);
+
+  // io_uring send path: the loop hands out the SQE and reaps the completion
+  void PrepSend(io_uring_sqe* sqe);
+  bool CompleteSend(int res);
+
+  /// <summary>
+  /// Fields touched on every event and broadcast, one cache line.
+  /// </summary>
+  struct Hot
+  {
+    int socket = -1;
+    uint32_t armedEvents = 0;   // mask currently armed in epoll, 0 once ONESHOT fired
+    bool dirty = false;         // already queued for re-arm this iteration
+    bool sendInFlight = false;  // io_uring sendmsg not reaped yet
+    bool closing = false;       // closed while the kernel still sends from its payloads, erased once done
+    bool inlineSend = true;
+    bool spliceRelay = false;
+    bool zeroCopy = false;
+    bool shedding = false;      // over the high watermark with DropNewest, until drained to the low one
+    bool overflowed = false;    // cut off by DisconnectOnOverflow, waiting for the hangup event
+    bool readPaused = false;    // backpressure: EPOLLIN is left out until the server drains
+    bool readPending = false;   // read budget ran out before EAGAIN, on the loop's ready list
+    bool writeBlocked = false;  // send hit EAGAIN, plain ET mode waits for the EPOLLOUT edge
+    uint8_t recvClass = 0;      // BufPool size class for the next recv
+    uint32_t queued = 0;        // messages in m_sendQueue, so IsWantSend() stays in this line
+    uint32_t pubBytes = 0;      // bytes published in the loop's current backpressure window
+    uint32_t pubEpoch = 0;      // window pubBytes counts for, stale ones read as 0
+    size_t sendOffset = 0;      // bytes of the front message already sent
+    size_t queuedBytes = 0;     // buffer bytes m_sendQueue pins (Footprint()), checked against the watermarks
+    EventLoop* loop = nullptr;
+  };
+
+  // Exposed to the loop's event dispatch and deferred epoll re-arm
+  Hot m_hot;
 
 private:
   void GracefulShutdown();
+  bool ReadRelay();
+  void YieldRead();
+  void ConsumeSent(size_t bytes);
+  bool AdmitSend(size_t bytes);
+  void Enqueue(const MsgRef& msg, size_t offset);
+  void DropOldest(size_t target);
+  void DropQueue();
+  void AddQueued(size_t bytes);
+  void SubQueued(size_t bytes);
+  void ReleaseZeroCopy(uint32_t lo, uint32_t hi);
+  bool UseZeroCopy(const MsgRef& msg) const;
 
 private:
-  int m_socket;
-  ChatServer* m_server;
+  // Shared payloads, front one is sent from m_hot.sendOffset.
+  // Taken from the loop on the first queued message and handed back once
+  // drained, so idle sessions own no buffers.
+  std::unique_ptr<std::deque<MsgRef>> m_sendQueue;
+
+  // Gather list of the in-flight io_uring sendmsg, allocated on first use
+  struct UringSend
+  {
+    static constexpr size_t IOV = 64;
+    iovec iov[IOV];
+    msghdr msg;
+  };
+  std::unique_ptr<UringSend> m_uringSend;
+
+  // Payloads handed to the kernel with MSG_ZEROCOPY, held until their completion id
+  // is reported. Allocated while any are pending, ids keep counting across.
+  struct ZeroCopyRef
+  {
+    uint32_t id;
+    MsgRef msg;
+  };
+  std::unique_ptr<std::deque<ZeroCopyRef>> m_zcPending;
+  uint32_t m_zcNextId = 0;
+
+  friend struct ClientSessionLayout;
+};
+
+/// <summary>
+/// Compile-time layout checks, a layout change that pushes hot state apart fails the build.
+/// </summary>
+struct ClientSessionLayout
+{
+  static constexpr size_t CACHE_LINE = 64;
 
-  std::deque<std::string> m_sendQueue;
+  static_assert(std::is_standard_layout<ClientSession::Hot>::value, "Hot must be standard layout");
+  static_assert(sizeof(ClientSession::Hot) <= CACHE_LINE, "Hot fields must fit one cache line");
+  static_assert(offsetof(ClientSession::Hot, loop) + sizeof(EventLoop*) <= CACHE_LINE, "Hot tail spills");
+  static_assert(alignof(ClientSession) == CACHE_LINE, "Session must start on a cache line");
+  static_assert(sizeof(ClientSession) <= 2 * CACHE_LINE, "Large or optional state belongs out of line");
 };
\ No newline at end of file
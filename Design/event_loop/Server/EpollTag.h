@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// Kind of fd registered in a loop's epoll set.
+/// New fd kinds (timerfd, signalfd, ...) get a value here and a case in EventLoop::Run().
+/// </summary>
+enum class FdKind : uint8_t
+{
+  Listener, Client, Wakeup, Timer, SendRing
+};
+
+/// <summary>
+/// Tagged handle stored in epoll_event.data.u64 as [kind:8][gen:24][fd:32],
+/// so events are dispatched without any lookup by fd.
+/// Generation is only meaningful for clients, see SessionSlab.
+/// </summary>
+struct EpollTag
+{
+  static constexpr uint32_t GEN_MASK = 0xFFFFFFu;
+
+  FdKind kind = FdKind::Client;
+  uint32_t gen = 0;
+  int fd = -1;
+
+  static uint64_t Pack(FdKind kind, int fd, uint32_t gen = 0)
+  {
+    return (static_cast<uint64_t>(kind) << 56) |
+      (static_cast<uint64_t>(gen & GEN_MASK) << 32) |
+      static_cast<uint32_t>(fd);
+  }
+
+  static EpollTag Unpack(uint64_t data)
+  {
+    EpollTag tag;
+    tag.kind = static_cast<FdKind>(data >> 56);
+    tag.gen = static_cast<uint32_t>(data >> 32) & GEN_MASK;
+    tag.fd = static_cast<int>(data & 0xFFFFFFFFu);
+    return tag;
+  }
+};
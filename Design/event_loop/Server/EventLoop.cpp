@@ -0,0 +1,986 @@
+#include "EventLoop.h"
+#include "ChatServer.h"
+#include "SocketUtils.h"
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+#include <sys/socket.h> // socket(), bind(), connect(), listen(), accept()
+#include <sys/eventfd.h> // eventfd()
+#include <fcntl.h>      // splice(), tee(), pipe2()
+#include <unistd.h>     // close()
+
+using std::cout;
+using std::cerr;
+
+constexpr int MAX_EVENTS = 1024;
+constexpr int BACKLOG_RETRY_MS = 1;     // epoll timeout while other inboxes are full
+constexpr int PAUSE_RECHECK_MS = 5;     // epoll timeout while publishers wait for other loops to drain
+constexpr unsigned SEND_RING_ENTRIES = 4096;
+constexpr size_t RELAY_CHUNK = 64 * 1024;  // bytes spliced per step, also the relay pipes' size
+constexpr size_t MAX_SPARE_QUEUES = 1024;  // drained send queues cached per loop, the rest is freed
+constexpr auto ZC_CLOSE_TIMEOUT = std::chrono::seconds(2); // closed sessions wait this long for zero-copy completions
+
+//
+// === EventLoop functions ===
+//
+
+EventLoop::EventLoop(ChatServer* server, size_t id)
+  : LoopBase(server, id), m_uringSend(m_opts.uringSend),
+    m_oneShot(m_opts.epollMode == EpollMode::OneShot) {}
+
+EventLoop::~EventLoop()
+{
+  // Loop thread is gone and its sends with it, payloads can be released
+  m_sendRing.Close();
+
+  for (int* p : { m_relayIn, m_relayOut })
+  {
+    SafeCloseSocket(p[0]);
+    SafeCloseSocket(p[1]);
+  }
+  SafeCloseSocket(m_devNull);
+
+  // Close clients
+  m_clients.Clear();
+
+  // Close listeners
+  for (auto& s : m_listenSockets)
+  {
+    SafeCloseSocket(s);
+  }
+  m_listenSockets.clear();
+
+  SafeCloseSocket(m_epoll);
+}
+
+/// <summary>
+/// Takes ownership of the listening sockets, creates the epoll set and the wakeup eventfd.
+/// </summary>
+bool EventLoop::Init(const std::vector<int>& listenSockets)
+{
+  m_listenSockets = listenSockets;
+  // Any fd may land in this loop, but the sessions are split among the loops
+  m_clients.Reserve(m_opts.prewarm, (m_opts.prewarm + m_opts.loops - 1) / m_opts.loops);
+
+  // Init epoll
+  m_epoll = epoll_create1(EPOLL_CLOEXEC);
+  if (m_epoll < 0)
+  {
+    perror("epoll_create1");
+    return false;
+  }
+
+  // Wakeup for other threads (cross-loop messages, stop)
+  if (!InitWakeup(EFD_NONBLOCK))
+  {
+    return false;
+  }
+  AddWakeupToEpoll();
+
+  // Completions of batched sends are reaped when the ring fd turns readable
+  if (m_uringSend)
+  {
+    if (!m_sendRing.Init(SEND_RING_ENTRIES))
+    {
+      return false;
+    }
+    AddSendRingToEpoll();
+  }
+
+  if (m_opts.spliceRelay && !InitRelay())
+  {
+    return false;
+  }
+
+  // Fill epoll with listeners
+  for (const auto& lsfd : m_listenSockets)
+  {
+    AddListenToEpoll(lsfd);
+  }
+
+  m_running.store(true, std::memory_order_release);
+  return true;
+}
+
+/// <summary>Top-level epoll loop broken into clear steps.</summary>
+void EventLoop::Run()
+{
+  std::vector<epoll_event> events(MAX_EVENTS);
+
+  while (m_running.load(std::memory_order_acquire))
+  {
+    // Blocks forever unless some messages still wait for a full inbox or sends
+    // for a busy send ring, send completions left sessions to resubmit, reads
+    // yielded or publishers are paused
+    int timeout = (!m_dirty.empty() || !m_ready.empty()) ? 0
+      : (HasBacklog() || m_sendRing.Unsubmitted() > 0) ? BACKLOG_RETRY_MS
+      : (!m_paused.empty() || !m_zcClosing.empty()) ? PAUSE_RECHECK_MS : -1;
+
+    int n = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), timeout);
+    m_stats.epollWaits.fetch_add(1, std::memory_order_relaxed);
+    if (n < 0)
+    {
+      if (errno == EINTR) continue; // Interrupted. Retry.
+      perror("epoll_wait");
+      break;
+    }
+    m_stats.events.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+
+    for (int i = 0; i < n; ++i)
+    {
+      EpollTag tag = EpollTag::Unpack(events[i].data.u64);
+      uint32_t ev = events[i].events;
+
+      switch (tag.kind)
+      {
+        case FdKind::Wakeup:
+          HandleWakeup();
+          break;
+
+        case FdKind::Listener:
+          HandleListeners(tag.fd, ev);
+          break;
+
+        case FdKind::Client:
+          HandleClients(tag.fd, tag.gen, ev);
+          break;
+
+        case FdKind::SendRing:
+          HandleSendRing();
+          break;
+
+        default: break;
+      }
+    }
+
+    ServiceReady();
+    ExpireZeroCopyCloses();
+    FlushBacklog();
+    UpdateBackpressure();
+    ApplyDirty();
+    SubmitSends();
+  }
+}
+
+//
+// === Handlers ===
+//
+
+void EventLoop::HandleListeners(int& sfd, uint32_t& event)
+{
+  if (event & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+  {
+    cerr << "Loop " << m_id << " listener fd = " << sfd << "error/hup/nval\n";
+    m_running.store(false, std::memory_order_release);
+    return;
+  }
+
+  if (event & EPOLLIN) 
+  {
+    AcceptAll(sfd);  // drain accept() to EAGAIN
+  }
+}
+
+void EventLoop::HandleClients(int& sfd, uint32_t gen, uint32_t& event)
+{
+  // Stale event: session was closed earlier in this batch and
+  // the fd number may already belong to a newly accepted client
+  ClientSession* sess = m_clients.Get(sfd, gen);
+  if (sess == nullptr) return;
+
+  // Closed with zero-copy sends outstanding: only their completions matter now.
+  // Once all are in, or the socket failed, it goes; the destructor resets it if needed.
+  if (sess->m_hot.closing)
+  {
+    if (sess->HasZeroCopyPending() && (!sess->ReapZeroCopy() || !sess->HasZeroCopyPending()))
+    {
+      CtlEpoll(EPOLL_CTL_DEL, sfd, 0, 0);
+      m_clients.Erase(sfd);
+      m_stats.closes.fetch_add(1, std::memory_order_relaxed);
+    }
+    return;
+  }
+
+  // ONESHOT disarmed the fd, it gets re-armed after the batch
+  if (m_oneShot)
+  {
+    sess->m_hot.armedEvents = 0;
+    MarkDirty(sfd);
+  }
+
+  // Zero-copy completions also raise EPOLLERR, only a real socket error closes
+  if ((event & EPOLLERR) && sess->IsZeroCopy())
+  {
+    if (!sess->ReapZeroCopy())
+    {
+      CloseClient(sfd);
+      return;
+    }
+    event &= ~EPOLLERR;
+  }
+
+  // Errors / hangups first
+  if (event & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+  {
+    CloseClient(sfd);
+    return;
+  }
+
+  // Readable, unless the ready list already owns the pending data
+  if ((event & EPOLLIN) && !sess->m_hot.readPending)
+  {
+    if (!sess->Read())
+    {
+      CloseClient(sfd);
+      return;
+    }
+
+    if (sess->m_hot.readPending)
+    {
+      EpollTag tag;
+      tag.fd = sfd;
+      tag.gen = gen;
+      m_ready.push_back(tag);
+    }
+  }
+
+  // Writable
+  if (event & EPOLLOUT)
+  {
+    sess->m_hot.writeBlocked = false;
+    if (!sess->Write())
+    {
+      CloseClient(sfd);
+      return;
+    }
+  }
+}
+
+/// <summary>
+/// Gives every session which yielded its read one more budget, in yield order.
+/// Those yielding again wait for the next pass, after the next event batch.
+/// </summary>
+void EventLoop::ServiceReady()
+{
+  if (m_ready.empty())
+    return;
+
+  m_readyNow.swap(m_ready);
+  for (const auto& tag : m_readyNow)
+  {
+    ClientSession* sess = m_clients.Get(tag.fd, tag.gen);
+    if (sess == nullptr || sess->m_hot.closing)
+      continue;
+
+    int sfd = tag.fd;
+    if (!sess->Read())
+    {
+      CloseClient(sfd);
+      continue;
+    }
+
+    if (sess->m_hot.readPending)
+    {
+      m_ready.push_back(tag);
+    }
+    else
+    {
+      // Drained to EAGAIN, back to waiting for edges
+      MarkDirty(tag.fd);
+    }
+  }
+
+  m_readyNow.clear();
+}
+
+/// <summary>
+/// Consumes the eventfd counter and fans out what other loops posted meanwhile.
+/// </summary>
+void EventLoop::HandleWakeup()
+{
+  uint64_t counter = 0;
+  while (read(m_wakeFd, &counter, sizeof(counter)) > 0) {}
+
+  DrainInbox();
+}
+
+/// <summary>
+/// Advances send queues by reaped sendmsg completions. Sessions with more
+/// queued get another SQE from ApplyDirty(), closing ones are released.
+/// </summary>
+void EventLoop::HandleSendRing()
+{
+  m_sendRing.ForEachCqe([this](const io_uring_cqe& cqe)
+  {
+    --m_sendsInFlight;
+
+    EpollTag tag = EpollTag::Unpack(cqe.user_data);
+    ClientSession* sess = m_clients.Get(tag.fd, tag.gen);
+    if (sess == nullptr)
+      return;
+
+    bool ok = sess->CompleteSend(cqe.res);
+    if (sess->m_hot.closing)
+    {
+      m_clients.Erase(tag.fd);
+      m_stats.closes.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    if (!ok)
+    {
+      CloseClient(tag.fd);
+      return;
+    }
+
+    MarkDirty(tag.fd);
+  });
+}
+
+//
+// === Handlers' helpers ===
+//
+
+/// <summary>
+/// Single place where fds enter the epoll set, tag tells Run() how to dispatch them.
+/// </summary>
+bool EventLoop::CtlEpoll(int op, int fd, uint32_t events, uint64_t tag)
+{
+  m_stats.epollCtl.fetch_add(1, std::memory_order_relaxed);
+
+  epoll_event ev{};
+  ev.events = events;
+  ev.data.u64 = tag;
+  return epoll_ctl(m_epoll, op, fd, &ev) == 0;
+}
+
+void EventLoop::AddListenToEpoll(const int& lsocket)
+{
+  // LT is OK for listen sockets
+  if (!CtlEpoll(EPOLL_CTL_ADD, lsocket, EPOLLIN, EpollTag::Pack(FdKind::Listener, lsocket)))
+  {
+    perror("epoll_ctl ADD listen");
+  }
+}
+
+void EventLoop::AddWakeupToEpoll()
+{
+  // LT, counter is drained on every wakeup
+  if (!CtlEpoll(EPOLL_CTL_ADD, m_wakeFd, EPOLLIN, EpollTag::Pack(FdKind::Wakeup, m_wakeFd)))
+  {
+    perror("epoll_ctl ADD eventfd");
+  }
+}
+
+void EventLoop::AddSendRingToEpoll()
+{
+  // LT, the CQ is emptied on every wakeup
+  int fd = m_sendRing.GetFd();
+  if (!CtlEpoll(EPOLL_CTL_ADD, fd, EPOLLIN, EpollTag::Pack(FdKind::SendRing, fd)))
+  {
+    perror("epoll_ctl ADD io_uring");
+  }
+}
+
+void EventLoop::AddClientToEpoll(const int& clsocket)
+{
+  ClientSession* sess = m_clients.Get(clsocket);
+  if (sess == nullptr)
+  {
+    return;
+  }
+
+  uint32_t mask = ClientEvents(sess);
+  uint64_t tag = EpollTag::Pack(FdKind::Client, clsocket, m_clients.GetGen(clsocket));
+  if (!CtlEpoll(EPOLL_CTL_ADD, clsocket, mask, tag))
+  {
+    perror("epoll_ctl ADD client");
+    return;
+  }
+
+  sess->m_hot.armedEvents = mask;
+}
+
+void EventLoop::AcceptAll(int& fd)
+{
+  while (true)
+  {
+    int cs = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK);
+
+    if (cs == -1)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        // No more clients
+        break;
+      }
+
+      std::perror("accept4");
+      break;
+    }
+
+    // Optional greeting
+    static const char* hello = "Welcome to the chat!\n";
+    send(cs, hello, strlen(hello), MSG_NOSIGNAL);
+
+    // Save in clients, add to epoll
+    if (m_clients.Emplace(cs, cs, this) == nullptr)
+    {
+      close(cs);
+      continue;
+    }
+    AddClientToEpoll(cs);
+    m_stats.accepts.fetch_add(1, std::memory_order_relaxed);
+
+    // Log peer address
+    sockaddr_storage addr;
+    socklen_t addLen = sizeof(addr);
+    memset(&addr, 0, addLen);
+
+    if (getpeername(cs, reinterpret_cast<sockaddr*>(&addr), &addLen) == 0)
+    {
+      cout << "Client connected to loop " << m_id << ": ";
+      PrintSockaddr(reinterpret_cast<sockaddr*>(&addr));
+    }
+    else
+    {
+      std::perror("getpeername");
+    }
+  }
+}
+
+uint32_t EventLoop::ClientEvents(ClientSession* sess)
+{
+  // Plain ET: edges are acted on or remembered by the session, only a paused
+  // publisher drops EPOLLIN, so its incoming data raises no events until resumed.
+  // io_uring waits for writability itself.
+  if (!m_oneShot)
+  {
+    return EPOLLRDHUP | EPOLLET | (sess->m_hot.readPaused ? 0u : static_cast<uint32_t>(EPOLLIN)) |
+      (m_uringSend ? 0u : static_cast<uint32_t>(EPOLLOUT));
+  }
+
+  // Base mask for clients under ET with ONESHOT which freezes fd.
+  // Paused publishers are still watched for hangups, ready-listed ones are read by the loop.
+  uint32_t mask = EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
+  if (!sess->m_hot.readPaused && !sess->m_hot.readPending)
+  {
+    mask |= EPOLLIN;
+  }
+
+  // io_uring waits for writability itself
+  if (sess->IsWantSend() && !m_uringSend)
+  {
+    mask |= EPOLLOUT;
+  }
+
+  return mask;
+}
+
+/// <summary>
+/// Queues the session for an interest check after the current event batch.
+/// Any number of calls per iteration cost at most one epoll_ctl.
+/// </summary>
+void EventLoop::MarkDirty(int fd)
+{
+  ClientSession* sess = m_clients.Get(fd);
+  if (sess == nullptr || sess->m_hot.dirty)
+    return;
+
+  sess->m_hot.dirty = true;
+
+  EpollTag tag;
+  tag.fd = fd;
+  tag.gen = m_clients.GetGen(fd);
+  m_dirty.push_back(tag);
+}
+
+/// <summary>
+/// Re-arms dirty sessions whose wanted mask differs from the armed one
+/// and, with io_uring sends, queues a sendmsg for each one with data waiting.
+/// Sessions which find the send ring full stay dirty for the next iteration.
+/// In plain ET mode only pausing or resuming a publisher changes the mask. Sessions
+/// with data queued on a socket that hasn't reported EAGAIN since the last EPOLLOUT
+/// edge are flushed here, since no further edge is coming for them.
+/// Sessions closed since they were marked are skipped by generation.
+/// </summary>
+void EventLoop::ApplyDirty()
+{
+  size_t kept = 0;
+  for (size_t i = 0; i < m_dirty.size(); ++i)
+  {
+    EpollTag tag = m_dirty[i];
+    ClientSession* sess = m_clients.Get(tag.fd, tag.gen);
+    if (sess == nullptr || sess->m_hot.closing)
+      continue;
+
+    if (m_uringSend && sess->IsWantSend() && !sess->m_hot.sendInFlight)
+    {
+      io_uring_sqe* sqe = m_sendsInFlight < m_sendRing.CqEntries() ? m_sendRing.GetSqe() : nullptr;
+      if (sqe == nullptr)
+      {
+        m_dirty[kept++] = tag;
+        continue;
+      }
+
+      sess->PrepSend(sqe);
+      sqe->user_data = EpollTag::Pack(FdKind::Client, tag.fd, tag.gen);
+      ++m_sendsInFlight;
+    }
+
+    sess->m_hot.dirty = false;
+
+    if (!m_oneShot && !m_uringSend && sess->IsWantSend() && !sess->m_hot.writeBlocked)
+    {
+      int sfd = tag.fd;
+      if (!sess->Write())
+      {
+        CloseClient(sfd);
+        continue;
+      }
+    }
+
+    uint32_t mask = ClientEvents(sess);
+    if (mask == sess->m_hot.armedEvents)
+      continue;
+
+    uint64_t data = EpollTag::Pack(FdKind::Client, tag.fd, tag.gen);
+    if (!CtlEpoll(EPOLL_CTL_MOD, tag.fd, mask, data))
+    {
+      perror("epoll_ctl MOD client");
+      continue;
+    }
+
+    sess->m_hot.armedEvents = mask;
+  }
+
+  m_dirty.resize(kept);
+}
+
+/// <summary>
+/// Hands every SQE queued this iteration to the kernel with a single io_uring_enter().
+/// SQEs an earlier enter left in the SQ (-EAGAIN/-EBUSY) are retried here as well.
+/// Sends which complete inline are reaped right away without another syscall.
+/// </summary>
+void EventLoop::SubmitSends()
+{
+  if (!m_uringSend)
+    return;
+
+  bool submitted = false;
+  if (m_sendRing.Unsubmitted() > 0)
+  {
+    int ret = m_sendRing.Submit(0);
+    if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY)
+    {
+      errno = -ret;
+      perror("io_uring_enter");
+    }
+    submitted = true;
+  }
+
+  // Counts the enter above and any GetSqe() made on a full SQ this iteration
+  uint64_t enters = m_sendRing.EnterCalls();
+  m_stats.sendCalls.fetch_add(enters - m_sendEntersCounted, std::memory_order_relaxed);
+  m_sendEntersCounted = enters;
+
+  if (submitted)
+  {
+    HandleSendRing();
+  }
+}
+
+/// <summary>
+/// Publishes this loop's outbound gauge, reads the server-wide one and
+/// resumes paused publishers once it is back under the low watermark.
+/// </summary>
+void EventLoop::UpdateBackpressure()
+{
+  m_stats.queuedBytes.store(m_queuedBytes, std::memory_order_relaxed);
+  if (m_opts.backpressure == 0)
+    return;
+
+  m_publishedQueued = m_queuedBytes;
+  m_globalQueued = m_server->QueuedBytes();
+
+  if (m_globalQueued > m_opts.backpressure)
+  {
+    m_saturated = true;
+  }
+  else if (m_saturated && m_globalQueued <= m_opts.backpressureLow)
+  {
+    ResumeReaders();
+  }
+
+  m_stats.pausedReaders.store(m_paused.size(), std::memory_order_relaxed);
+}
+
+std::unique_ptr<std::deque<MsgRef>> EventLoop::TakeSendQueue()
+{
+  if (m_spareQueues.empty())
+    return std::make_unique<std::deque<MsgRef>>();
+
+  std::unique_ptr<std::deque<MsgRef>> queue = std::move(m_spareQueues.back());
+  m_spareQueues.pop_back();
+  return queue;
+}
+
+/// <summary>
+/// Caches a queue a session no longer needs. An emptied deque keeps its map
+/// and one block, so the next session to queue on it allocates nothing.
+/// </summary>
+void EventLoop::GivebackSendQueue(std::unique_ptr<std::deque<MsgRef>> queue)
+{
+  if (m_spareQueues.size() >= MAX_SPARE_QUEUES)
+    return;
+
+  queue->clear();
+  m_spareQueues.push_back(std::move(queue));
+}
+
+/// <summary>
+/// Accounts bytes a session just published. Returns false if the session
+/// is one of the heaviest publishers while the server is saturated; its
+/// reads are then paused and it must stop reading.
+/// </summary>
+bool EventLoop::AdmitPublish(ClientSession* sess, size_t bytes)
+{
+  if (m_opts.backpressure == 0)
+    return true;
+
+  ClientSession::Hot& hot = sess->m_hot;
+  if (hot.pubEpoch != m_pubEpoch)
+  {
+    hot.pubEpoch = m_pubEpoch;
+    hot.pubBytes = 0;
+  }
+
+  uint64_t pub = static_cast<uint64_t>(hot.pubBytes) + bytes;
+  hot.pubBytes = pub > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(pub);
+  if (hot.pubBytes > m_heaviestPub)
+  {
+    m_heaviestPub = hot.pubBytes;
+  }
+
+  if (!m_saturated)
+  {
+    // Own queues grow between iterations, other loops' shares are as last published
+    uint64_t global = m_globalQueued - m_publishedQueued + m_queuedBytes;
+    if (global <= m_opts.backpressure)
+      return true;
+
+    m_saturated = true;
+  }
+
+  // Light publishers keep talking, only those near the heaviest one are held back
+  if (static_cast<uint64_t>(hot.pubBytes) * 2 < m_heaviestPub)
+    return true;
+
+  hot.readPaused = true;
+
+  EpollTag tag;
+  tag.fd = hot.socket;
+  tag.gen = m_clients.GetGen(hot.socket);
+  m_paused.push_back(tag);
+  // EPOLLIN comes off in ApplyDirty()
+  MarkDirty(hot.socket);
+  m_stats.readPauses.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+/// <summary>
+/// Re-arms EPOLLIN for every paused publisher and starts a new publish window.
+/// Data left in their sockets is read through the ready list, no new edge reports it.
+/// </summary>
+void EventLoop::ResumeReaders()
+{
+  for (const auto& tag : m_paused)
+  {
+    ClientSession* sess = m_clients.Get(tag.fd, tag.gen);
+    if (sess == nullptr)
+      continue;
+
+    // Data waiting in the socket raised its edge long ago, the ready list reads it
+    sess->m_hot.readPaused = false;
+    if (!sess->m_hot.readPending)
+    {
+      sess->m_hot.readPending = true;
+      m_ready.push_back(tag);
+    }
+    MarkDirty(tag.fd);
+  }
+
+  m_paused.clear();
+  m_saturated = false;
+  ++m_pubEpoch;
+  m_heaviestPub = 0;
+}
+
+void EventLoop::CloseClient(int& sfd)
+{
+  ClientSession* sess = m_clients.Get(sfd);
+  if (sess != nullptr && sess->HasZeroCopyPending() && m_epoll != -1)
+  {
+    ParkZeroCopyClose(sfd, sess);
+    sfd = -1;
+    return;
+  }
+
+  // remove socket from epoll before its fd number can be reused
+  if (m_epoll != -1)
+    CtlEpoll(EPOLL_CTL_DEL, sfd, 0, 0);
+
+  // Kernel still reads the queued payloads, keep the session (and its fd number)
+  // until the send completes. Shutdown makes it complete promptly.
+  if (sess != nullptr && sess->m_hot.sendInFlight)
+  {
+    sess->m_hot.closing = true;
+    shutdown(sfd, SHUT_RDWR);
+    sfd = -1;
+    return;
+  }
+
+  // Session owns the socket. Closing it twice here could hit an fd
+  // that another loop has just accepted with the same number.
+  m_clients.Erase(sfd);
+  m_stats.closes.fetch_add(1, std::memory_order_relaxed);
+
+  sfd = -1;
+}
+
+/// <summary>
+/// The kernel may still be sending from the session's MSG_ZEROCOPY payloads, so the
+/// session and its refs stay until the error queue reports them. The socket stays in
+/// the epoll set for EPOLLERR alone, edge-triggered, and FIN follows the queued data.
+/// Broadcasts and re-arms skip it as closing.
+/// </summary>
+void EventLoop::ParkZeroCopyClose(int fd, ClientSession* sess)
+{
+  sess->m_hot.closing = true;
+  shutdown(fd, SHUT_WR);
+
+  uint32_t gen = m_clients.GetGen(fd);
+  if (!CtlEpoll(EPOLL_CTL_MOD, fd, EPOLLET, EpollTag::Pack(FdKind::Client, fd, gen)))
+  {
+    perror("epoll_ctl MOD zero-copy close");
+  }
+
+  EpollTag tag;
+  tag.fd = fd;
+  tag.gen = gen;
+  m_zcClosing.push_back({ tag, std::chrono::steady_clock::now() + ZC_CLOSE_TIMEOUT });
+}
+
+/// <summary>
+/// Releases parked sessions whose completions all arrived, and resets the ones past
+/// their deadline: a peer that stopped reading would otherwise pin them for good.
+/// </summary>
+void EventLoop::ExpireZeroCopyCloses()
+{
+  if (m_zcClosing.empty())
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  size_t kept = 0;
+  for (size_t i = 0; i < m_zcClosing.size(); ++i)
+  {
+    const ZeroCopyClose& zc = m_zcClosing[i];
+    ClientSession* sess = m_clients.Get(zc.tag.fd, zc.tag.gen);
+    if (sess == nullptr)
+      continue;
+
+    if (sess->HasZeroCopyPending() && now < zc.deadline)
+    {
+      m_zcClosing[kept++] = zc;
+      continue;
+    }
+
+    // Destructor resets the connection if payloads are still pending
+    int fd = zc.tag.fd;
+    CtlEpoll(EPOLL_CTL_DEL, fd, 0, 0);
+    m_clients.Erase(fd);
+    m_stats.closes.fetch_add(1, std::memory_order_relaxed);
+  }
+  m_zcClosing.resize(kept);
+}
+
+/// <summary>
+/// Queues the message to every local session except the sender.
+/// Sessions only take a reference, payload bytes are never copied.
+/// </summary>
+void EventLoop::FanOut(const MsgRef& msg, ClientSession* pSender)
+{
+  const auto& live = m_clients.Live();
+  const auto& fds = m_clients.LiveFds();
+
+  for (size_t i = 0; i < live.size(); ++i)
+  {
+    ClientSession* s = live[i];
+    if (s != pSender && !s->m_hot.closing)
+    {
+      s->PostSend(msg);
+      // Ensure we get notified to flush
+      MarkDirty(fds[i]);
+    }
+  }
+}
+
+/// <summary>
+/// Broadcasts a message received by a local session to every client on every loop.
+/// </summary>
+void EventLoop::BroadcastMsg(const MsgRef& msg, ClientSession* pSender)
+{
+  m_stats.msgsIn.fetch_add(1, std::memory_order_relaxed);
+
+  FanOut(msg, pSender);
+  m_server->BroadcastMsg(msg, this);
+
+  cout << "Message broadcasted:" << msg.View() << "\n";
+}
+
+void EventLoop::FanOutPosted(const MsgRef& msg)
+{
+  FanOut(msg, nullptr);
+}
+
+//
+// === Splice relay ===
+//
+
+bool EventLoop::InitRelay()
+{
+  for (int* p : { m_relayIn, m_relayOut })
+  {
+    if (pipe2(p, O_NONBLOCK | O_CLOEXEC) < 0)
+    {
+      perror("pipe2");
+      return false;
+    }
+
+    // One chunk must fit, or tee() would duplicate only part of it
+    if (fcntl(p[1], F_SETPIPE_SZ, static_cast<int>(RELAY_CHUNK)) < 0)
+    {
+      perror("fcntl F_SETPIPE_SZ");
+      return false;
+    }
+  }
+
+  m_devNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+  if (m_devNull < 0)
+  {
+    perror("open /dev/null");
+    return false;
+  }
+
+  m_relayBuf.resize(RELAY_CHUNK);
+  return true;
+}
+
+/// <summary>
+/// Relays one chunk from the sender without bringing it to user space where possible.
+/// Idle local recipients get it via tee() + splice(). Recipients with a queue
+/// (ordering) and other loops get one shared user-space copy.
+/// Returns what splice() from the sender socket returned.
+/// </summary>
+ssize_t EventLoop::RelayFrom(int sfd, ClientSession* pSender)
+{
+  ssize_t n = splice(sfd, nullptr, m_relayIn[1], nullptr, RELAY_CHUNK, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (n <= 0)
+    return n;
+
+  m_stats.msgsIn.fetch_add(1, std::memory_order_relaxed);
+  size_t len = static_cast<size_t>(n);
+
+  const auto& live = m_clients.Live();
+  const auto& fds = m_clients.LiveFds();
+
+  m_relayBusy.clear();
+  for (size_t i = 0; i < live.size(); ++i)
+  {
+    ClientSession* s = live[i];
+    // Cut off sessions are shut down, splicing into them only raises EPIPE
+    if (s == pSender || s->m_hot.closing || s->m_hot.overflowed)
+      continue;
+
+    if (s->IsWantSend() || !SpliceTo(s, fds[i], len))
+    {
+      m_relayBusy.push_back(i);
+    }
+  }
+
+  // Copy once for everyone who can't take it kernel-side, otherwise just drop it
+  if (!m_relayBusy.empty() || m_opts.loops > 1)
+  {
+    MsgRef msg = ReadPipe(m_relayIn[0], len);
+    for (size_t i : m_relayBusy)
+    {
+      live[i]->PostSend(msg);
+      MarkDirty(fds[i]);
+    }
+    m_server->BroadcastMsg(msg, this);
+  }
+  else
+  {
+    splice(m_relayIn[0], nullptr, m_devNull, nullptr, len, SPLICE_F_MOVE);
+  }
+
+  m_stats.relayedBytes.fetch_add(len, std::memory_order_relaxed);
+  return n;
+}
+
+/// <summary>
+/// Duplicates the chunk into the scratch pipe and splices it to the recipient.
+/// Whatever the socket doesn't take right away is queued as a user-space copy.
+/// Returns false if the chunk couldn't be duplicated at all.
+/// </summary>
+bool EventLoop::SpliceTo(ClientSession* sess, int fd, size_t len)
+{
+  ssize_t t = tee(m_relayIn[0], m_relayOut[1], len, SPLICE_F_NONBLOCK);
+  if (t != static_cast<ssize_t>(len))
+  {
+    if (t > 0)
+      splice(m_relayOut[0], nullptr, m_devNull, nullptr, static_cast<size_t>(t), SPLICE_F_MOVE);
+    return false;
+  }
+
+  size_t sent = 0;
+  while (sent < len)
+  {
+    ssize_t r = splice(m_relayOut[0], nullptr, fd, nullptr, len - sent, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    m_stats.sendCalls.fetch_add(1, std::memory_order_relaxed);
+    if (r <= 0)
+      break; // EAGAIN or error, errors surface on the session's next Write() or EPOLLERR
+
+    sent += static_cast<size_t>(r);
+  }
+
+  // Scratch pipe must be empty for the next recipient
+  if (sent < len)
+  {
+    sess->PostRest(ReadPipe(m_relayOut[0], len - sent));
+    MarkDirty(fd);
+  }
+
+  return true;
+}
+
+/// <summary>
+/// Moves len bytes sitting in a relay pipe into a new shared payload.
+/// </summary>
+MsgRef EventLoop::ReadPipe(int fd, size_t len)
+{
+  size_t got = 0;
+  while (got < len)
+  {
+    ssize_t r = read(fd, m_relayBuf.data() + got, len - got);
+    if (r <= 0)
+      break;
+
+    got += static_cast<size_t>(r);
+  }
+
+  return MsgRef::Create(m_relayBuf.data(), got);
+}
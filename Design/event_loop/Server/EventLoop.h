@@ -0,0 +1,122 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <sys/epoll.h>   // epoll()
+
+#include "EpollTag.h"
+#include "IoUring.h"
+#include "LoopBase.h"
+#include "MsgBuf.h"
+#include "SessionSlab.h"
+#include "ClientSession.h"
+
+/// <summary>
+/// Epoll reactor: one epoll set, own listeners and own shard of client sessions.
+/// </summary>
+class EventLoop : public LoopBase
+{
+public:
+  EventLoop(ChatServer* server, size_t id);
+  ~EventLoop() override;
+
+  bool Init(const std::vector<int>& listenSockets) override;
+  void Run() override;
+
+  void BroadcastMsg(const MsgRef& msg, ClientSession* pSender);
+  ssize_t RelayFrom(int sfd, ClientSession* pSender);
+  bool AdmitPublish(ClientSession* sess, size_t bytes);
+
+  // Drained send queues are kept for the next session that queues,
+  // so a broadcast to idle sessions allocates no queues
+  std::unique_ptr<std::deque<MsgRef>> TakeSendQueue();
+  void GivebackSendQueue(std::unique_ptr<std::deque<MsgRef>> queue);
+
+protected:
+  void FanOutPosted(const MsgRef& msg) override;
+
+private:
+  void HandleListeners(int& sfd, uint32_t& event);
+  void HandleClients(int& sfd, uint32_t gen, uint32_t& event);
+  void HandleWakeup();
+  void HandleSendRing();
+
+  bool CtlEpoll(int op, int fd, uint32_t events, uint64_t tag);
+  void AddListenToEpoll(const int& lsocket);
+  void AddClientToEpoll(const int& clsocket);
+  void AddWakeupToEpoll();
+  void AddSendRingToEpoll();
+
+  void AcceptAll(int& fd);
+  void CloseClient(int& sfd);
+  void ParkZeroCopyClose(int fd, ClientSession* sess);
+  void ExpireZeroCopyCloses();
+  uint32_t ClientEvents(ClientSession* sess);
+  void MarkDirty(int fd);
+  void ApplyDirty();
+  void SubmitSends();
+  void UpdateBackpressure();
+  void ServiceReady();
+  void ResumeReaders();
+  void FanOut(const MsgRef& msg, ClientSession* pSender);
+  bool InitRelay();
+  bool SpliceTo(ClientSession* sess, int fd, size_t len);
+  MsgRef ReadPipe(int fd, size_t len);
+
+private:
+  int m_epoll = -1;
+
+  std::vector<int> m_listenSockets;
+  SessionSlab<ClientSession> m_clients;
+  std::vector<std::unique_ptr<std::deque<MsgRef>>> m_spareQueues;
+
+  // Sessions whose epoll interest may need a re-arm, applied once after each event batch
+  std::vector<EpollTag> m_dirty;
+
+  // Sessions which spent their read budget with data left, read again after each
+  // event batch. m_readyNow is the pass being served, re-yields go to the next one.
+  std::vector<EpollTag> m_ready;
+  std::vector<EpollTag> m_readyNow;
+
+  // Optional send path: dirty sessions queue a sendmsg SQE each,
+  // submitted with one io_uring_enter() per iteration. At most one CQ's worth
+  // is in flight, completions past that would pile up in the kernel's overflow list.
+  bool m_uringSend = false;
+  IoUring m_sendRing;
+  unsigned m_sendsInFlight = 0;
+  uint64_t m_sendEntersCounted = 0; // m_sendRing.EnterCalls() already added to sendCalls
+
+  // Closed sessions the kernel may still send MSG_ZEROCOPY payloads from. They stay
+  // registered for their error queue until it reports every id, or the deadline
+  // passes and the destructor resets the connection.
+  struct ZeroCopyClose
+  {
+    EpollTag tag;
+    std::chrono::steady_clock::time_point deadline;
+  };
+  std::vector<ZeroCopyClose> m_zcClosing;
+
+  // EpollMode::OneShot: handled clients are disarmed and re-armed by ApplyDirty()
+  bool m_oneShot = false;
+
+  // Splice relay: sender's bytes land in m_relayIn, are tee()d through the
+  // scratch pipe m_relayOut to each idle recipient and dropped into /dev/null
+  int m_relayIn[2] = { -1, -1 };
+  int m_relayOut[2] = { -1, -1 };
+  int m_devNull = -1;
+  std::vector<size_t> m_relayBusy;  // live indices of recipients needing a user-space copy
+  std::vector<char> m_relayBuf;
+
+  // Backpressure: while the server-wide outbound gauge is over opts.backpressure,
+  // the heaviest local publishers stop being read until it drains to backpressureLow
+  bool m_saturated = false;
+  uint64_t m_globalQueued = 0;  // server-wide gauge as of the last UpdateBackpressure()
+  size_t m_publishedQueued = 0; // this loop's share of it
+  uint32_t m_pubEpoch = 0;      // publish window, a new one starts on every resume
+  uint32_t m_heaviestPub = 0;   // most bytes one local session published this window
+  std::vector<EpollTag> m_paused;
+};
@@ -0,0 +1,183 @@
+#include "IoUring.h"
+
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+
+#include <sys/mman.h>    // mmap(), munmap()
+#include <sys/syscall.h> // __NR_io_uring_*
+#include <unistd.h>      // syscall(), close()
+
+//
+// === UTILS ===
+//
+
+static int SysSetup(unsigned entries, io_uring_params* params)
+{
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int SysEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+//
+// === IoUring functions ===
+//
+
+IoUring::~IoUring()
+{
+  Close();
+}
+
+/// <summary>
+/// Creates the ring with the given SQ size and maps SQ, CQ and SQE array.
+/// </summary>
+bool IoUring::Init(unsigned entries)
+{
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  m_fd = SysSetup(entries, &params);
+  if (m_fd < 0)
+  {
+    perror("io_uring_setup");
+    return false;
+  }
+
+  m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+  const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (singleMmap)
+  {
+    if (m_cqRingSize > m_sqRingSize) m_sqRingSize = m_cqRingSize;
+    m_cqRingSize = m_sqRingSize;
+  }
+
+  m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+  if (m_sqRing == MAP_FAILED)
+  {
+    m_sqRing = nullptr;
+    perror("mmap sq ring");
+    Close();
+    return false;
+  }
+
+  if (singleMmap)
+  {
+    m_cqRing = m_sqRing;
+  }
+  else
+  {
+    m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+    if (m_cqRing == MAP_FAILED)
+    {
+      m_cqRing = nullptr;
+      perror("mmap cq ring");
+      Close();
+      return false;
+    }
+  }
+
+  m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+  {
+    perror("mmap sqes");
+    Close();
+    return false;
+  }
+  m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+  char* sq = static_cast<char*>(m_sqRing);
+  m_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  m_sqEntries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+
+  char* cq = static_cast<char*>(m_cqRing);
+  m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  m_cqEntries = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_entries);
+  m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+  m_sqeHead = m_sqeTail = *m_sqTail;
+  return true;
+}
+
+/// <summary>
+/// Unmaps the rings and closes the ring fd, kernel cancels whatever is still in flight.
+/// </summary>
+void IoUring::Close()
+{
+  if (m_sqes != nullptr)
+  {
+    munmap(m_sqes, m_sqesSize);
+    m_sqes = nullptr;
+  }
+
+  if (m_cqRing != nullptr && m_cqRing != m_sqRing)
+  {
+    munmap(m_cqRing, m_cqRingSize);
+  }
+  m_cqRing = nullptr;
+
+  if (m_sqRing != nullptr)
+  {
+    munmap(m_sqRing, m_sqRingSize);
+    m_sqRing = nullptr;
+  }
+
+  if (m_fd != -1)
+  {
+    close(m_fd);
+    m_fd = -1;
+  }
+}
+
+io_uring_sqe* IoUring::GetSqe()
+{
+  unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+  if (m_sqeTail - head >= m_sqEntries)
+  {
+    // Ring is full, hand what we have to the kernel and retry once
+    Submit(0);
+    head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+    if (m_sqeTail - head >= m_sqEntries)
+      return nullptr;
+  }
+
+  io_uring_sqe* sqe = &m_sqes[m_sqeTail & m_sqMask];
+  memset(sqe, 0, sizeof(*sqe));
+  ++m_sqeTail;
+  return sqe;
+}
+
+int IoUring::Submit(unsigned waitNr)
+{
+  // Publish handed out SQEs to the kernel
+  unsigned tail = *m_sqTail;
+  for (; m_sqeHead != m_sqeTail; ++m_sqeHead, ++tail)
+  {
+    m_sqArray[tail & m_sqMask] = m_sqeHead & m_sqMask;
+  }
+  __atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+
+  // Includes entries an interrupted enter left unconsumed
+  unsigned toSubmit = tail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+
+  if (toSubmit == 0 && waitNr == 0)
+    return 0;
+
+  unsigned flags = waitNr > 0 ? IORING_ENTER_GETEVENTS : 0;
+  ++m_enterCalls;
+  int ret = SysEnter(m_fd, toSubmit, waitNr, flags);
+  return ret < 0 ? -errno : ret;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h> // io_uring_sqe, io_uring_cqe
+
+/// <summary>
+/// Minimal io_uring wrapper over the raw syscalls (no liburing).
+/// Maps the submission/completion rings, hands out SQEs and reaps CQEs.
+/// Not thread-safe: one ring per loop thread.
+/// </summary>
+class IoUring
+{
+public:
+  IoUring() = default;
+  ~IoUring();
+
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  bool Init(unsigned entries);
+  void Close();
+
+  // Zeroed SQE or nullptr if the SQ is still full after flushing it to the kernel
+  io_uring_sqe* GetSqe();
+
+  // Submits queued SQEs and waits for at least waitNr completions.
+  // Returns number submitted or -errno.
+  int Submit(unsigned waitNr = 0);
+
+  unsigned Pending() const { return m_sqeTail - m_sqeHead; }
+
+  // Handed out SQEs the kernel hasn't consumed yet, including ones an interrupted
+  // or refused (-EAGAIN/-EBUSY) enter left in the SQ
+  unsigned Unsubmitted() const
+  {
+    return m_sqHead != nullptr ? m_sqeTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) : 0;
+  }
+
+  // io_uring_enter() calls made so far, the ones GetSqe() makes on a full SQ included
+  uint64_t EnterCalls() const { return m_enterCalls; }
+  unsigned CqEntries() const { return m_cqEntries; }
+  int GetFd() const { return m_fd; }
+
+  /// <summary>
+  /// Calls fn(const io_uring_cqe&) for every ready completion and marks them seen.
+  /// </summary>
+  template <typename F>
+  unsigned ForEachCqe(F&& fn)
+  {
+    unsigned head = *m_cqHead;
+    unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+    unsigned count = 0;
+
+    for (; head != tail; ++head, ++count)
+    {
+      fn(m_cqes[head & m_cqMask]);
+    }
+
+    __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+    return count;
+  }
+
+private:
+  int m_fd = -1;
+
+  // Submission ring
+  void* m_sqRing = nullptr;
+  size_t m_sqRingSize = 0;
+  unsigned* m_sqHead = nullptr;
+  unsigned* m_sqTail = nullptr;
+  unsigned* m_sqArray = nullptr;
+  unsigned m_sqMask = 0;
+  unsigned m_sqEntries = 0;
+  io_uring_sqe* m_sqes = nullptr;
+  size_t m_sqesSize = 0;
+  unsigned m_sqeHead = 0; // first SQE not yet submitted
+  unsigned m_sqeTail = 0; // next SQE to hand out
+  uint64_t m_enterCalls = 0;
+
+  // Completion ring, may share the mapping with the submission ring
+  void* m_cqRing = nullptr;
+  size_t m_cqRingSize = 0;
+  unsigned* m_cqHead = nullptr;
+  unsigned* m_cqTail = nullptr;
+  unsigned m_cqMask = 0;
+  unsigned m_cqEntries = 0;
+  io_uring_cqe* m_cqes = nullptr;
+};
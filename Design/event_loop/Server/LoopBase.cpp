@@ -0,0 +1,152 @@
+#include "LoopBase.h"
+#include "ChatServer.h"
+#include "SocketUtils.h"
+
+#include <iostream>
+
+#include <sys/eventfd.h> // eventfd()
+#include <unistd.h>     // write()
+
+constexpr size_t INBOX_CAPACITY = 4096; // msgs from other loops
+constexpr size_t INBOX_BATCH = 256;     // msgs fanned out per wakeup
+
+//
+// === LoopBase functions ===
+//
+
+LoopBase::LoopBase(ChatServer* server, size_t id)
+  : m_id(id), m_server(server), m_opts(server->GetOptions()),
+    m_bufPool(BufPool::Create()), m_inbox(INBOX_CAPACITY) {}
+
+LoopBase::~LoopBase()
+{
+  SafeCloseSocket(m_wakeFd);
+
+  // Buffers still queued on other loops keep the pool alive
+  m_bufPool->Detach();
+}
+
+/// <summary>
+/// Asks the loop to exit. Safe to call from any thread.
+/// </summary>
+void LoopBase::Stop()
+{
+  m_running.store(false, std::memory_order_release);
+  Wakeup();
+}
+
+/// <summary>
+/// Creates the eventfd other threads signal on cross-loop messages and stop.
+/// </summary>
+bool LoopBase::InitWakeup(int flags)
+{
+  m_wakeFd = eventfd(0, flags | EFD_CLOEXEC);
+  if (m_wakeFd < 0)
+  {
+    perror("eventfd");
+    return false;
+  }
+
+  return true;
+}
+
+/// <summary>
+/// Fans out up to INBOX_BATCH messages other loops posted meanwhile.
+/// If more are left, the loop wakes itself up again to serve I/O in between.
+/// Backend must have consumed the eventfd counter before calling this.
+/// </summary>
+void LoopBase::DrainInbox()
+{
+  // Re-open the wakeup before draining, so a post racing with the drain
+  // either gets popped below or signals the eventfd again.
+  m_wakePending.exchange(false, std::memory_order_acq_rel);
+
+  MsgRef msg;
+  for (size_t i = 0; i < INBOX_BATCH; ++i)
+  {
+    if (!m_inbox.TryPop(msg))
+      return;
+
+    FanOutPosted(msg);
+  }
+
+  if (!m_inbox.IsEmpty() && !m_wakePending.exchange(true, std::memory_order_acq_rel))
+  {
+    Wakeup();
+  }
+}
+
+/// <summary>
+/// Hands a message over to another loop. Keeps per-loop order: once a message
+/// got stuck on a full inbox, everything after it waits in the backlog too.
+/// </summary>
+void LoopBase::ForwardMsg(LoopBase* pDest, const MsgRef& msg)
+{
+  if (m_backlog.size() <= pDest->m_id)
+  {
+    m_backlog.resize(pDest->m_id + 1);
+  }
+
+  auto& backlog = m_backlog[pDest->m_id];
+  if (backlog.empty() && pDest->PostMsg(msg))
+  {
+    return;
+  }
+
+  backlog.push_back(msg);
+  ++m_backlogSize;
+}
+
+/// <summary>
+/// Retries messages which did not fit into other loops' inboxes.
+/// </summary>
+void LoopBase::FlushBacklog()
+{
+  if (m_backlogSize == 0)
+    return;
+
+  for (size_t id = 0; id < m_backlog.size(); ++id)
+  {
+    auto& backlog = m_backlog[id];
+    LoopBase* pDest = m_server->GetLoop(id);
+
+    while (!backlog.empty() && pDest->PostMsg(backlog.front()))
+    {
+      backlog.pop_front();
+      --m_backlogSize;
+    }
+  }
+}
+
+/// <summary>
+/// Posts a reference to a message from another loop's thread to be fanned out by this loop.
+/// Only the producer which finds no wakeup pending writes to the eventfd.
+/// Returns false if the inbox is full.
+/// </summary>
+bool LoopBase::PostMsg(const MsgRef& msg)
+{
+  MsgRef copy(msg);
+  if (!m_inbox.TryPush(copy))
+  {
+    return false;
+  }
+
+  if (!m_wakePending.exchange(true, std::memory_order_acq_rel))
+  {
+    Wakeup();
+  }
+
+  return true;
+}
+
+void LoopBase::Wakeup()
+{
+  if (m_wakeFd == -1)
+    return;
+
+  uint64_t one = 1;
+  if (write(m_wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+  {
+    perror("write eventfd");
+  }
+}
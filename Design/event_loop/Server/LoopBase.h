@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <cstdint>
+
+#include "BufPool.h"
+#include "MpscQueue.h"
+#include "MsgBuf.h"
+#include "ServerOptions.h"
+
+class ChatServer;
+
+/// <summary>
+/// Loop counters, written by the loop thread and read by the stats reporter.
+/// </summary>
+struct LoopStats
+{
+  std::atomic<uint64_t> epollCtl{0};
+  std::atomic<uint64_t> epollWaits{0};
+  std::atomic<uint64_t> events{0};    // readiness events or completions dispatched
+  std::atomic<uint64_t> accepts{0};
+  std::atomic<uint64_t> closes{0};
+  std::atomic<uint64_t> msgsIn{0};
+  std::atomic<uint64_t> readYields{0}; // reads cut short by the read budget
+  std::atomic<uint64_t> sendCalls{0}; // send()/sendmsg() or io_uring_enter() carrying sends
+  std::atomic<uint64_t> relayedBytes{0}; // bytes moved by the splice relay
+  std::atomic<uint64_t> zeroCopySends{0};
+  std::atomic<uint64_t> zeroCopyCopied{0}; // completions where the kernel fell back to copying
+  std::atomic<uint64_t> txDropNewest{0};   // messages refused by a full send queue
+  std::atomic<uint64_t> txDropOldest{0};   // queued messages evicted for newer ones
+  std::atomic<uint64_t> txDisconnects{0};  // sessions cut off for overflowing
+  std::atomic<uint64_t> queuedBytes{0};    // gauge: buffer bytes pinned by send queues, published once per iteration
+  std::atomic<uint64_t> pausedReaders{0};  // gauge: publishers whose reads are paused by backpressure
+  std::atomic<uint64_t> readPauses{0};
+};
+
+/// <summary>
+/// Part shared by every loop backend: identity, stop flag, counters and the
+/// cross-loop handoff (lock-free inbox woken by an eventfd, backlog for full inboxes).
+/// Backends own their sessions and implement Init(), Run() and local fan-out.
+/// Everything except Stop() and PostMsg() must be called from the loop's thread.
+/// </summary>
+class LoopBase
+{
+public:
+  LoopBase(ChatServer* server, size_t id);
+  virtual ~LoopBase();
+
+  virtual bool Init(const std::vector<int>& listenSockets) = 0;
+  virtual void Run() = 0;
+  // Threads running Run() on this loop at once
+  virtual size_t Workers() const { return 1; }
+  void Stop();
+
+  void ForwardMsg(LoopBase* pDest, const MsgRef& msg);
+  bool PostMsg(const MsgRef& msg);
+
+  const LoopStats& GetStats() const { return m_stats; }
+  LoopStats& GetStats() { return m_stats; }
+  BufPool& GetBufPool() { return *m_bufPool; }
+  const ServerOptions& GetOptions() const { return m_opts; }
+
+  // Outbound bytes in this loop's send queues, kept by the sessions
+  void AddQueuedBytes(size_t n) { m_queuedBytes += n; }
+  void SubQueuedBytes(size_t n) { m_queuedBytes -= n; }
+
+protected:
+  // Fans a message posted by another loop out to local sessions
+  virtual void FanOutPosted(const MsgRef& msg) = 0;
+
+  bool InitWakeup(int flags);
+  void DrainInbox();
+  void FlushBacklog();
+  bool HasBacklog() const { return m_backlogSize > 0; }
+  void Wakeup();
+
+protected:
+  std::atomic<bool> m_running{false};
+  size_t m_id = 0;
+  int m_wakeFd = -1;
+  ChatServer* m_server = nullptr;
+  ServerOptions m_opts;
+  LoopStats m_stats;
+  size_t m_queuedBytes = 0;
+
+  // Receive buffers which become broadcast payloads, released from any loop
+  BufPool* m_bufPool = nullptr;
+
+private:
+  // Messages posted by other loops, drained in batches on wakeup.
+  // m_wakePending is set by the producer which found the inbox idle,
+  // so a burst of posts costs a single eventfd write.
+  MpscQueue<MsgRef> m_inbox;
+  std::atomic<bool> m_wakePending{false};
+
+  // Messages for other loops whose inboxes were full, indexed by loop id
+  std::vector<std::deque<MsgRef>> m_backlog;
+  size_t m_backlogSize = 0;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/// <summary>
+/// Bounded lock-free multi-producer / single-consumer queue (Vyukov ring).
+/// Every cell carries a sequence number telling whether it is free for the
+/// producer of a given lap or filled for the consumer. Capacity is rounded up to a power of two.
+/// </summary>
+template <typename T>
+class MpscQueue
+{
+public:
+  explicit MpscQueue(size_t capacity)
+  {
+    size_t cap = 2;
+    while (cap < capacity)
+    {
+      cap <<= 1;
+    }
+
+    m_mask = cap - 1;
+    m_cells.reset(new Cell[cap]);
+    for (size_t i = 0; i < cap; ++i)
+    {
+      m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  /// <summary>
+  /// Any thread. Returns false if the queue is full, value is left untouched then.
+  /// </summary>
+  bool TryPush(T& value)
+  {
+    size_t pos = m_tail.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+
+    while (true)
+    {
+      cell = &m_cells[pos & m_mask];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+      if (diff == 0)
+      {
+        // Cell is free on this lap, try to claim it
+        if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+      {
+        // Consumer has not freed this cell yet
+        return false;
+      }
+      else
+      {
+        // Other producer took it, reload
+        pos = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->data = std::move(value);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// <summary>
+  /// Consumer thread only. Returns false if the queue is empty.
+  /// </summary>
+  bool TryPop(T& out)
+  {
+    Cell* cell = &m_cells[m_head & m_mask];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+
+    if (seq != m_head + 1)
+      return false;
+
+    out = std::move(cell->data);
+    cell->data = T();
+    cell->seq.store(m_head + m_mask + 1, std::memory_order_release);
+    ++m_head;
+    return true;
+  }
+
+  /// <summary>
+  /// Consumer thread only. Snapshot, producers may add more right after.
+  /// </summary>
+  bool IsEmpty() const
+  {
+    const Cell& cell = m_cells[m_head & m_mask];
+    return cell.seq.load(std::memory_order_acquire) != m_head + 1;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> seq{0};
+    T data{};
+  };
+
+  std::unique_ptr<Cell[]> m_cells;
+  size_t m_mask = 0;
+
+  // Producers and consumer indexes live on separate cache lines
+  alignas(64) std::atomic<size_t> m_tail{0};
+  alignas(64) size_t m_head = 0;
+};
@@ -0,0 +1,60 @@
+#include "MsgBuf.h"
+#include "BufPool.h"
+
+#include <new>
+#include <cstring>
+
+std::atomic<uint64_t> MsgBuf::s_allocs{0};
+
+//
+// === MsgBuf functions ===
+//
+
+/// <summary>
+/// Allocates header and payload in one block and copies the payload in.
+/// Returned buffer holds one reference owned by the caller.
+/// </summary>
+MsgBuf* MsgBuf::Create(const char* data, size_t size)
+{
+  MsgBuf* buf = Allocate(size);
+  buf->m_size = size;
+
+  if (size > 0)
+  {
+    memcpy(buf->MutableData(), data, size);
+  }
+
+  return buf;
+}
+
+/// <summary>
+/// Empty buffer with room for capacity payload bytes and one reference.
+/// </summary>
+MsgBuf* MsgBuf::Allocate(size_t capacity)
+{
+  s_allocs.fetch_add(1, std::memory_order_relaxed);
+
+  void* mem = ::operator new(sizeof(MsgBuf) + capacity);
+  return new (mem) MsgBuf(0, capacity);
+}
+
+void MsgBuf::Free(MsgBuf* buf)
+{
+  buf->~MsgBuf();
+  ::operator delete(buf);
+}
+
+void MsgBuf::Release()
+{
+  // acq_rel so the last owner sees every other owner's use of the payload
+  if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    if (m_pool != nullptr)
+    {
+      m_pool->Recycle(this);
+      return;
+    }
+
+    Free(this);
+  }
+}
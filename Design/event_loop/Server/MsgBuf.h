@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+class BufPool;
+
+/// <summary>
+/// Immutable refcounted message payload. Allocated and filled once per broadcast,
+/// then shared by every recipient queue on every loop. Header and bytes live
+/// in a single allocation which is freed, or handed back to its BufPool,
+/// when the last reference goes away.
+/// </summary>
+class MsgBuf
+{
+public:
+  static MsgBuf* Create(const char* data, size_t size);
+
+  // Heap allocations of payloads so far, pooled or not
+  static uint64_t AllocCount() { return s_allocs.load(std::memory_order_relaxed); }
+
+  const char* Data() const { return reinterpret_cast<const char*>(this + 1); }
+  size_t Size() const { return m_size; }
+  size_t Capacity() const { return m_capacity; }
+
+  // Filling, only while the creator holds the sole reference
+  char* MutableData() { return reinterpret_cast<char*>(this + 1); }
+  void SetSize(size_t size) { m_size = size; }
+
+  void AddRef() { m_refs.fetch_add(1, std::memory_order_relaxed); }
+  void Release();
+
+private:
+  friend class BufPool;
+
+  MsgBuf(size_t size, size_t capacity) : m_capacity(static_cast<uint32_t>(capacity)), m_size(size) {}
+  ~MsgBuf() = default;
+
+  static MsgBuf* Allocate(size_t capacity);
+  static void Free(MsgBuf* buf);
+
+private:
+  std::atomic<uint32_t> m_refs{1};
+  uint32_t m_capacity = 0;
+  size_t m_size = 0;
+
+  // Set for pooled buffers only
+  BufPool* m_pool = nullptr;
+  MsgBuf* m_next = nullptr;   // free list link
+  uint8_t m_class = 0;
+
+  static std::atomic<uint64_t> s_allocs;
+  // payload bytes follow the header
+};
+
+/// <summary>
+/// Owning reference to a MsgBuf, atomic refcount so it may cross loops.
+/// </summary>
+class MsgRef
+{
+public:
+  MsgRef() = default;
+  explicit MsgRef(MsgBuf* buf) : m_buf(buf) {} // adopts the creator's reference
+
+  MsgRef(const MsgRef& other) : m_buf(other.m_buf)
+  {
+    if (m_buf) m_buf->AddRef();
+  }
+
+  MsgRef(MsgRef&& other) noexcept : m_buf(other.m_buf)
+  {
+    other.m_buf = nullptr;
+  }
+
+  MsgRef& operator=(MsgRef other) noexcept
+  {
+    std::swap(m_buf, other.m_buf);
+    return *this;
+  }
+
+  ~MsgRef()
+  {
+    if (m_buf) m_buf->Release();
+  }
+
+  static MsgRef Create(const char* data, size_t size) { return MsgRef(MsgBuf::Create(data, size)); }
+
+  explicit operator bool() const { return m_buf != nullptr; }
+
+  const char* Data() const { return m_buf->Data(); }
+  size_t Size() const { return m_buf ? m_buf->Size() : 0; }
+  // Bytes the buffer pins while referenced. A pooled receive buffer is a whole size
+  // class however little it holds, so this is what send queue bounds count.
+  size_t Footprint() const { return m_buf ? m_buf->Capacity() : 0; }
+  std::string_view View() const { return std::string_view(Data(), Size()); }
+
+private:
+  MsgBuf* m_buf = nullptr;
+};
@@ -2,20 +2,254 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <climits>
+#include <cstdlib>
+#include <cerrno>
+#include <csignal>
 
 #include "ChatServer.h"
 
+static const char* USAGE =
+  "Usage: Server [port] [ip...] [--loops=N] [--workers=M] [--prewarm=N] [--stats=SEC] [--read-budget=BYTES]"
+  " [--inline-send=0|1] [--uring-send=0|1] [--zerocopy=BYTES] [--relay=copy|splice] [--tx-hwm=BYTES] [--tx-lwm=BYTES]"
+  " [--tx-overflow=drop-newest|drop-oldest|disconnect] [--backpressure=BYTES] [--backpressure-low=BYTES]"
+  " [--backend=epoll|uring] [--epoll-mode=et|oneshot]\n";
+
+/// <summary>
+/// Parses a non-negative decimal option value. Anything else, signs and
+/// trailing characters included, is rejected.
+/// </summary>
+static bool ParseCount(const std::string& value, size_t& out)
+{
+  if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+
+  errno = 0;
+  unsigned long long v = std::strtoull(value.c_str(), nullptr, 10);
+  if (errno == ERANGE || v > SIZE_MAX)
+    return false;
+
+  out = static_cast<size_t>(v);
+  return true;
+}
+
+/// <summary>
+/// Parses a 0|1 switch.
+/// </summary>
+static bool ParseFlag(const std::string& value, bool& out)
+{
+  if (value != "0" && value != "1")
+    return false;
+
+  out = value == "1";
+  return true;
+}
+
+static int UsageError(const std::string& what)
+{
+  std::cerr << what << "\n" << USAGE;
+  return 1;
+}
+
+static int BadOption(const std::string& arg)
+{
+  return UsageError("Invalid option: " + arg);
+}
+
 int main(int argc, char* argv[])
 {
   std::vector<std::string> ipadds;
   std::string port = "27015";
+  ServerOptions opts;
+
+  // Watermarks left out are derived from the high ones, given ones are checked
+  bool txLwmSet = false;
+  bool backpressureLowSet = false;
+
+  // The worker pool runs none of the per-loop machinery, name the first option that needs it
+  std::string loopOnly;
+
+  std::vector<std::string> args;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg.rfind("--loops=", 0) == 0)
+    {
+      loopOnly = "--loops";
+      if (!ParseCount(arg.substr(8), opts.loops))
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--workers=", 0) == 0)
+    {
+      if (!ParseCount(arg.substr(10), opts.workers))
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--prewarm=", 0) == 0)
+    {
+      if (!ParseCount(arg.substr(10), opts.prewarm))
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--stats=", 0) == 0)
+    {
+      size_t sec = 0;
+      if (!ParseCount(arg.substr(8), sec) || sec > UINT_MAX)
+        return BadOption(arg);
+      opts.statsSec = static_cast<unsigned>(sec);
+      continue;
+    }
+
+    if (arg.rfind("--read-budget=", 0) == 0)
+    {
+      loopOnly = "--read-budget";
+      if (!ParseCount(arg.substr(14), opts.readBudget))
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--inline-send=", 0) == 0)
+    {
+      if (!ParseFlag(arg.substr(14), opts.inlineSend))
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--uring-send=", 0) == 0)
+    {
+      loopOnly = "--uring-send";
+      if (!ParseFlag(arg.substr(13), opts.uringSend))
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--zerocopy=", 0) == 0)
+    {
+      loopOnly = "--zerocopy";
+      if (!ParseCount(arg.substr(11), opts.zeroCopyMin))
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--relay=", 0) == 0)
+    {
+      loopOnly = "--relay";
+      std::string relay = arg.substr(8);
+      if (relay != "copy" && relay != "splice")
+        return BadOption(arg);
+      opts.spliceRelay = relay == "splice";
+      continue;
+    }
+
+    if (arg.rfind("--tx-hwm=", 0) == 0)
+    {
+      if (!ParseCount(arg.substr(9), opts.txHwm))
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--tx-lwm=", 0) == 0)
+    {
+      if (!ParseCount(arg.substr(9), opts.txLwm))
+        return BadOption(arg);
+      txLwmSet = true;
+      continue;
+    }
+
+    if (arg.rfind("--tx-overflow=", 0) == 0)
+    {
+      std::string mode = arg.substr(14);
+      if (mode == "drop-newest")
+        opts.txOverflow = TxOverflowMode::DropNewest;
+      else if (mode == "drop-oldest")
+        opts.txOverflow = TxOverflowMode::DropOldest;
+      else if (mode == "disconnect")
+        opts.txOverflow = TxOverflowMode::DisconnectOnOverflow;
+      else
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--backpressure=", 0) == 0)
+    {
+      loopOnly = "--backpressure";
+      if (!ParseCount(arg.substr(15), opts.backpressure))
+        return BadOption(arg);
+      continue;
+    }
+
+    if (arg.rfind("--backpressure-low=", 0) == 0)
+    {
+      loopOnly = "--backpressure-low";
+      if (!ParseCount(arg.substr(19), opts.backpressureLow))
+        return BadOption(arg);
+      backpressureLowSet = true;
+      continue;
+    }
+
+    if (arg.rfind("--epoll-mode=", 0) == 0)
+    {
+      loopOnly = "--epoll-mode";
+      std::string mode = arg.substr(13);
+      if (mode != "et" && mode != "oneshot")
+        return BadOption(arg);
+      opts.epollMode = (mode == "oneshot") ? EpollMode::OneShot : EpollMode::EdgeTriggered;
+      continue;
+    }
+
+    if (arg.rfind("--backend=", 0) == 0)
+    {
+      loopOnly = "--backend";
+      std::string backend = arg.substr(10);
+      if (backend != "epoll" && backend != "uring")
+        return BadOption(arg);
+      opts.backend = (backend == "uring") ? Backend::IoUring : Backend::Epoll;
+      continue;
+    }
 
-  if (argc > 1) 
+    // Unknown --options would otherwise be taken for an ip address
+    if (arg.rfind("--", 0) == 0)
+      return BadOption(arg);
+
+    args.push_back(arg);
+  }
+
+  if (opts.workers > 0 && !loopOnly.empty())
   {
-    port = argv[1];
+    return UsageError(loopOnly + " does not apply to --workers");
+  }
 
-    for (int i = 2; i < argc; ++i)
-      ipadds.emplace_back(argv[i]);
+  // Low watermark above the high one would never let a shedding queue recover
+  if (!txLwmSet)
+  {
+    if (opts.txLwm > opts.txHwm)
+      opts.txLwm = opts.txHwm / 4;
+  }
+  else if (opts.txHwm != 0 && opts.txLwm > opts.txHwm)
+  {
+    return UsageError("--tx-lwm must not be above --tx-hwm");
+  }
+
+  // Same for paused publishers, half the budget unless told otherwise
+  if (!backpressureLowSet)
+  {
+    opts.backpressureLow = opts.backpressure / 2;
+  }
+  else if (opts.backpressure != 0 && opts.backpressureLow > opts.backpressure)
+  {
+    return UsageError("--backpressure-low must not be above --backpressure");
+  }
+
+  if (!args.empty()) 
+  {
+    port = args[0];
+
+    for (size_t i = 1; i < args.size(); ++i)
+      ipadds.emplace_back(args[i]);
   }
 
   // If no ip provided, than standard
@@ -29,9 +263,13 @@ int main(int argc, char* argv[])
     };
   }
 
+  // send() paths pass MSG_NOSIGNAL, but splice() into a socket and write() into
+  // a pipe can't: a peer gone mid-relay must be an EPIPE, not a dead server
+  std::signal(SIGPIPE, SIG_IGN);
+
   try
   {
-    auto pServer = std::make_unique<ChatServer>(ipadds, port);
+    auto pServer = std::make_unique<ChatServer>(ipadds, port, opts);
     pServer->Start();
   }
   catch (const std::exception& ex)
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+
+/// <summary>
+/// I/O model each loop runs.
+/// </summary>
+enum class Backend
+{
+  Epoll,    // readiness reactor
+  IoUring   // completion proactor
+};
+
+/// <summary>
+/// How client fds sit in an epoll set.
+/// </summary>
+enum class EpollMode
+{
+  EdgeTriggered, // registered once, never modified: only the owning loop thread waits on the set
+  OneShot        // every event disarms the fd and the handler re-arms it: safe with several waiters
+};
+
+/// <summary>
+/// What a session does with a message once its send queue is over the high watermark.
+/// </summary>
+enum class TxOverflowMode
+{
+  DropNewest,          // refuse new messages until the queue drains to the low watermark
+  DropOldest,          // evict queued messages down to the low watermark, keep the new one
+  DisconnectOnOverflow // slow reader is cut off
+};
+
+/// <summary>
+/// Startup options parsed from the command line.
+/// </summary>
+struct ServerOptions
+{
+  size_t loops = 0;         // 0 = one loop per core
+  size_t workers = 0;       // >0: one shared epoll set served by this many threads instead of sharded loops
+  size_t prewarm = 0;       // sessions allocated up front, split among the loops (fds below N)
+  unsigned statsSec = 0;    // stats report period, 0 = off
+  size_t readBudget = 256 * 1024; // epoll loop: bytes read from one session per turn before others get theirs, 0 = drain
+  bool inlineSend = true;   // try send() right away when a session has nothing queued
+  bool uringSend = false;   // epoll loop: batch sends through io_uring, one submit per iteration
+  size_t zeroCopyMin = 0;   // epoll loop: payloads of at least this size go out with MSG_ZEROCOPY, 0 = off
+  bool spliceRelay = false; // epoll loop: relay bytes socket -> pipe -> sockets with splice()/tee()
+  size_t txHwm = 16 * 1024 * 1024; // per-session queued buffer bytes that trigger txOverflow, 0 = unbounded
+  size_t txLwm = 4 * 1024 * 1024;  // bytes a shedding queue must drain to before it takes messages again
+  TxOverflowMode txOverflow = TxOverflowMode::DisconnectOnOverflow;
+  size_t backpressure = 0;    // epoll loop: server-wide queued bytes that pause the heaviest publishers' reads, 0 = off
+  size_t backpressureLow = 0; // queued bytes at which paused publishers are read again
+  Backend backend = Backend::Epoll;
+  EpollMode epollMode = EpollMode::EdgeTriggered;
+};
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// Dense slab of sessions looked up by socket fd.
+/// Two tables: an fd-indexed one holding just a generation and the dense index
+/// per fd, and the sessions themselves, constructed in place in fixed-size chunks
+/// of loop-local slots handed out through a freelist. fds are process-wide while
+/// a loop owns only its share of them, so only the 8-byte fd entries scale with the
+/// highest fd; session storage scales with the sessions this loop actually has.
+/// Slot addresses stay stable, there is no heap allocation per session and slots
+/// are cache-line aligned. The generation is bumped on erase, events carrying an
+/// old generation are stale. Generations wrap at 24 bits so they fit into an EpollTag.
+/// Live sessions are also kept in a compact array for broadcasts.
+/// </summary>
+template <typename T>
+class SessionSlab
+{
+public:
+  static constexpr uint32_t GEN_MASK = 0xFFFFFFu;
+
+  SessionSlab() = default;
+  ~SessionSlab() { Clear(); }
+
+  SessionSlab(const SessionSlab&) = delete;
+  SessionSlab& operator=(const SessionSlab&) = delete;
+
+  /// <summary>
+  /// Constructs a session for fd in place. Returns nullptr if the fd is taken.
+  /// </summary>
+  template <typename... Args>
+  T* Emplace(int fd, Args&&... args)
+  {
+    FdSlot* fs = GetFdSlot(fd, true);
+    if (fs == nullptr || fs->dense != -1)
+      return nullptr;
+
+    uint32_t id = AllocSlot();
+    T* pSess = new (SlotAt(id)) T(std::forward<Args>(args)...);
+    fs->dense = static_cast<int32_t>(m_live.size());
+    m_live.push_back(pSess);
+    m_liveFds.push_back(fd);
+    m_liveSlots.push_back(id);
+    return pSess;
+  }
+
+  /// <summary>
+  /// Returns the live session for fd or nullptr.
+  /// </summary>
+  T* Get(int fd)
+  {
+    FdSlot* fs = GetFdSlot(fd, false);
+    if (fs == nullptr || fs->dense == -1)
+      return nullptr;
+
+    return m_live[fs->dense];
+  }
+
+  /// <summary>
+  /// Returns the live session for fd only if it is still the same generation.
+  /// </summary>
+  T* Get(int fd, uint32_t gen)
+  {
+    FdSlot* fs = GetFdSlot(fd, false);
+    if (fs == nullptr || fs->dense == -1 || fs->gen != gen)
+      return nullptr;
+
+    return m_live[fs->dense];
+  }
+
+  /// <summary>
+  /// Current generation of the fd. Never 0, so 0 can mark non-session fds.
+  /// </summary>
+  uint32_t GetGen(int fd)
+  {
+    FdSlot* fs = GetFdSlot(fd, false);
+    return fs != nullptr ? fs->gen : 0;
+  }
+
+  /// <summary>
+  /// Destroys the session, returns its slot to the freelist, bumps the fd
+  /// generation and swaps the last live session into the freed dense position.
+  /// </summary>
+  void Erase(int fd)
+  {
+    FdSlot* fs = GetFdSlot(fd, false);
+    if (fs == nullptr || fs->dense == -1)
+      return;
+
+    size_t idx = static_cast<size_t>(fs->dense);
+    m_live[idx]->~T();
+    m_freeSlots.push_back(m_liveSlots[idx]);
+
+    size_t last = m_live.size() - 1;
+    if (idx != last)
+    {
+      m_live[idx] = m_live[last];
+      m_liveFds[idx] = m_liveFds[last];
+      m_liveSlots[idx] = m_liveSlots[last];
+      GetFdSlot(m_liveFds[idx], false)->dense = static_cast<int32_t>(idx);
+    }
+    m_live.pop_back();
+    m_liveFds.pop_back();
+    m_liveSlots.pop_back();
+
+    fs->dense = -1;
+    fs->gen = (fs->gen + 1) & GEN_MASK;
+    if (fs->gen == 0)
+    {
+      fs->gen = 1;
+    }
+  }
+
+  void Clear()
+  {
+    while (!m_liveFds.empty())
+    {
+      Erase(m_liveFds.back());
+    }
+  }
+
+  /// <summary>
+  /// Pre-warms fd entries for fds [0, fds) and storage for the given number of
+  /// sessions, so a connection storm does not allocate chunks.
+  /// </summary>
+  void Reserve(size_t fds, size_t sessions)
+  {
+    if (fds > 0)
+    {
+      GetFdSlot(static_cast<int>(fds - 1), true);
+      for (auto& chunk : m_fdChunks)
+      {
+        if (!chunk)
+          chunk.reset(new FdSlot[FD_CHUNK_SIZE]);
+      }
+    }
+
+    while (m_slotChunks.size() * SLOT_CHUNK_SIZE < sessions)
+    {
+      m_slotChunks.emplace_back(new Slot[SLOT_CHUNK_SIZE]);
+    }
+    m_live.reserve(sessions);
+    m_liveFds.reserve(sessions);
+    m_liveSlots.reserve(sessions);
+    m_freeSlots.reserve(sessions);
+  }
+
+  size_t Size() const { return m_live.size(); }
+  bool Empty() const { return m_live.empty(); }
+
+  // Compact arrays of live sessions and their fds, same order
+  const std::vector<T*>& Live() const { return m_live; }
+  const std::vector<int>& LiveFds() const { return m_liveFds; }
+
+private:
+  static constexpr size_t FD_CHUNK_SHIFT = 10;  // 1024 fd entries (8 KB) per chunk
+  static constexpr size_t FD_CHUNK_SIZE = size_t(1) << FD_CHUNK_SHIFT;
+  static constexpr size_t SLOT_CHUNK_SHIFT = 8; // 256 sessions per chunk
+  static constexpr size_t SLOT_CHUNK_SIZE = size_t(1) << SLOT_CHUNK_SHIFT;
+  static constexpr size_t CACHE_LINE = 64;
+  static constexpr size_t SLOT_ALIGN = alignof(T) > CACHE_LINE ? alignof(T) : CACHE_LINE;
+
+  struct FdSlot
+  {
+    uint32_t gen = 1;
+    int32_t dense = -1; // index in m_live, -1 if free
+  };
+
+  // Each session starts on its own cache line, neighbours never share one
+  struct Slot
+  {
+    alignas(SLOT_ALIGN) unsigned char storage[sizeof(T)];
+  };
+
+  FdSlot* GetFdSlot(int fd, bool create)
+  {
+    if (fd < 0)
+      return nullptr;
+
+    size_t chunk = static_cast<size_t>(fd) >> FD_CHUNK_SHIFT;
+    if (chunk >= m_fdChunks.size())
+    {
+      if (!create)
+        return nullptr;
+
+      m_fdChunks.resize(chunk + 1);
+    }
+
+    if (!m_fdChunks[chunk])
+    {
+      if (!create)
+        return nullptr;
+
+      m_fdChunks[chunk].reset(new FdSlot[FD_CHUNK_SIZE]);
+    }
+
+    return &m_fdChunks[chunk][static_cast<size_t>(fd) & (FD_CHUNK_SIZE - 1)];
+  }
+
+  /// <summary>
+  /// Most recently freed slot first, it is the one most likely still in cache.
+  /// </summary>
+  uint32_t AllocSlot()
+  {
+    if (!m_freeSlots.empty())
+    {
+      uint32_t id = m_freeSlots.back();
+      m_freeSlots.pop_back();
+      return id;
+    }
+
+    uint32_t id = m_slotCount++;
+    if ((id >> SLOT_CHUNK_SHIFT) >= m_slotChunks.size())
+    {
+      m_slotChunks.emplace_back(new Slot[SLOT_CHUNK_SIZE]);
+    }
+    return id;
+  }
+
+  void* SlotAt(uint32_t id)
+  {
+    return m_slotChunks[id >> SLOT_CHUNK_SHIFT][id & (SLOT_CHUNK_SIZE - 1)].storage;
+  }
+
+private:
+  std::vector<std::unique_ptr<FdSlot[]>> m_fdChunks;
+  std::vector<std::unique_ptr<Slot[]>> m_slotChunks;
+  uint32_t m_slotCount = 0;        // slots ever handed out, the rest of the last chunk is untouched
+  std::vector<uint32_t> m_freeSlots;
+
+  std::vector<T*> m_live;
+  std::vector<int> m_liveFds;
+  std::vector<uint32_t> m_liveSlots; // storage slot of each live session, same order
+};
@@ -0,0 +1,335 @@
+#include "SharedLoop.h"
+#include "ChatServer.h"
+#include "SocketUtils.h"
+#include "BufPool.h"
+
+#include <iostream>
+#include <cstring>
+#include <mutex>
+
+#include <sys/socket.h> // accept4(), send()
+#include <sys/eventfd.h> // EFD_NONBLOCK
+#include <unistd.h>     // close()
+
+using std::cout;
+using std::cerr;
+
+constexpr int MAX_EVENTS = 64; // per worker, small batches keep ready fds spread over workers
+
+//
+// === SharedLoop functions ===
+//
+
+SharedLoop::SharedLoop(ChatServer* server, size_t id)
+  : LoopBase(server, id) {}
+
+SharedLoop::~SharedLoop()
+{
+  // Workers are joined, the last references are the map's
+  m_sessions.clear();
+
+  // Worker 0 receives into LoopBase's pool, the rest into their own
+  for (size_t i = 1; i < m_pools.size(); ++i)
+  {
+    m_pools[i]->Detach();
+  }
+
+  // Close listeners
+  for (auto& s : m_listenSockets)
+  {
+    SafeCloseSocket(s);
+  }
+  m_listenSockets.clear();
+
+  SafeCloseSocket(m_epoll);
+}
+
+/// <summary>
+/// Takes ownership of the listening sockets, creates the shared epoll set,
+/// the stop eventfd and a receive buffer pool per worker.
+/// </summary>
+bool SharedLoop::Init(const std::vector<int>& listenSockets)
+{
+  m_listenSockets = listenSockets;
+
+  m_epoll = epoll_create1(EPOLL_CLOEXEC);
+  if (m_epoll < 0)
+  {
+    perror("epoll_create1");
+    return false;
+  }
+
+  // LT and never drained: once Stop() writes it, every worker's epoll_wait returns
+  if (!InitWakeup(EFD_NONBLOCK))
+  {
+    return false;
+  }
+  if (!CtlEpoll(EPOLL_CTL_ADD, m_wakeFd, EPOLLIN, EpollTag::Pack(FdKind::Wakeup, m_wakeFd)))
+  {
+    perror("epoll_ctl ADD eventfd");
+    return false;
+  }
+
+  m_pools.push_back(m_bufPool);
+  for (size_t i = 1; i < Workers(); ++i)
+  {
+    m_pools.push_back(BufPool::Create());
+  }
+
+  // ET reports a backlog edge once, so one worker drains it
+  for (const auto& lsfd : m_listenSockets)
+  {
+    if (!CtlEpoll(EPOLL_CTL_ADD, lsfd, EPOLLIN | EPOLLET, EpollTag::Pack(FdKind::Listener, lsfd)))
+    {
+      perror("epoll_ctl ADD listen");
+    }
+  }
+
+  m_running.store(true, std::memory_order_release);
+  return true;
+}
+
+/// <summary>
+/// Worker body, called once by each of the Workers() threads.
+/// </summary>
+void SharedLoop::Run()
+{
+  size_t worker = m_nextWorker.fetch_add(1, std::memory_order_relaxed);
+  BufPool& pool = *m_pools[worker % m_pools.size()];
+
+  std::vector<epoll_event> events(MAX_EVENTS);
+
+  while (m_running.load(std::memory_order_acquire))
+  {
+    int n = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), -1);
+    m_stats.epollWaits.fetch_add(1, std::memory_order_relaxed);
+    if (n < 0)
+    {
+      if (errno == EINTR) continue; // Interrupted. Retry.
+      perror("epoll_wait");
+      break;
+    }
+    m_stats.events.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+
+    for (int i = 0; i < n; ++i)
+    {
+      EpollTag tag = EpollTag::Unpack(events[i].data.u64);
+      uint32_t ev = events[i].events;
+
+      switch (tag.kind)
+      {
+        case FdKind::Wakeup:
+          break; // only Stop() writes it, the loop condition sees it
+
+        case FdKind::Listener:
+          HandleListener(tag.fd, ev);
+          break;
+
+        case FdKind::Client:
+          HandleClient(tag, ev, pool);
+          break;
+
+        default: break;
+      }
+    }
+  }
+}
+
+//
+// === Handlers ===
+//
+
+void SharedLoop::HandleListener(int sfd, uint32_t event)
+{
+  if (event & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+  {
+    cerr << "Listener fd = " << sfd << " error/hup/nval\n";
+    Stop();
+    return;
+  }
+
+  if (event & EPOLLIN)
+  {
+    AcceptAll(sfd);  // drain accept() to EAGAIN, ET won't report the rest
+  }
+}
+
+/// <summary>
+/// Handles one event of a session. ONESHOT disarmed it, so normally no other
+/// worker is in here for the same session; it is re-armed on the way out.
+/// </summary>
+void SharedLoop::HandleClient(const EpollTag& tag, uint32_t event, BufPool& pool)
+{
+  std::shared_ptr<SharedSession> sess = Find(tag);
+  if (!sess || sess->IsClosing())
+    return;
+
+  // Errors / hangups first
+  if (event & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+  {
+    CloseSession(sess);
+    return;
+  }
+
+  // Readable
+  if (event & EPOLLIN)
+  {
+    if (!sess->Read(pool))
+    {
+      CloseSession(sess);
+      return;
+    }
+  }
+
+  // Writable
+  if (event & EPOLLOUT)
+  {
+    if (!sess->Write())
+    {
+      CloseSession(sess);
+      return;
+    }
+  }
+
+  if (!sess->Rearm())
+  {
+    perror("epoll_ctl MOD client");
+    CloseSession(sess);
+  }
+}
+
+//
+// === Handlers' helpers ===
+//
+
+/// <summary>
+/// Single place where fds enter the epoll set. Any worker.
+/// </summary>
+bool SharedLoop::CtlEpoll(int op, int fd, uint32_t events, uint64_t tag)
+{
+  m_stats.epollCtl.fetch_add(1, std::memory_order_relaxed);
+
+  epoll_event ev{};
+  ev.events = events;
+  ev.data.u64 = tag;
+  return epoll_ctl(m_epoll, op, fd, &ev) == 0;
+}
+
+void SharedLoop::AcceptAll(int sfd)
+{
+  while (true)
+  {
+    int cs = accept4(sfd, nullptr, nullptr, SOCK_NONBLOCK);
+
+    if (cs == -1)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        // No more clients
+        break;
+      }
+
+      std::perror("accept4");
+      break;
+    }
+
+    // Optional greeting
+    static const char* hello = "Welcome to the chat!\n";
+    send(cs, hello, strlen(hello), MSG_NOSIGNAL);
+
+    uint32_t gen = m_nextGen.fetch_add(1, std::memory_order_relaxed) & EpollTag::GEN_MASK;
+    auto sess = std::make_shared<SharedSession>(cs, gen, this);
+
+    // Registered while the map is locked, so the first event's lookup
+    // and the first fan-out both find the session armed
+    {
+      std::unique_lock<std::shared_mutex> lock(m_sessionsMutex);
+      if (!sess->Register())
+      {
+        perror("epoll_ctl ADD client");
+        continue; // session closes the socket
+      }
+      m_sessions[cs] = sess;
+    }
+    m_stats.accepts.fetch_add(1, std::memory_order_relaxed);
+
+    // Log peer address
+    sockaddr_storage addr;
+    socklen_t addLen = sizeof(addr);
+    memset(&addr, 0, addLen);
+
+    if (getpeername(cs, reinterpret_cast<sockaddr*>(&addr), &addLen) == 0)
+    {
+      cout << "Client connected: ";
+      PrintSockaddr(reinterpret_cast<sockaddr*>(&addr));
+    }
+    else
+    {
+      std::perror("getpeername");
+    }
+  }
+}
+
+/// <summary>
+/// Removes the session from epoll and the map. The socket is closed once the
+/// last worker holding a reference lets go, so its fd number can't be reused early.
+/// </summary>
+void SharedLoop::CloseSession(const std::shared_ptr<SharedSession>& sess)
+{
+  if (!sess->MarkClosing())
+    return;
+
+  int sfd = sess->GetSocket();
+  CtlEpoll(EPOLL_CTL_DEL, sfd, 0, 0);
+
+  {
+    std::unique_lock<std::shared_mutex> lock(m_sessionsMutex);
+    auto it = m_sessions.find(sfd);
+    if (it != m_sessions.end() && it->second == sess)
+    {
+      m_sessions.erase(it);
+    }
+  }
+  m_stats.closes.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::shared_ptr<SharedSession> SharedLoop::Find(const EpollTag& tag)
+{
+  std::shared_lock<std::shared_mutex> lock(m_sessionsMutex);
+  auto it = m_sessions.find(tag.fd);
+  if (it == m_sessions.end() || it->second->GetGen() != tag.gen)
+    return nullptr;
+
+  return it->second;
+}
+
+/// <summary>
+/// Queues the message to every session except the sender. Every session is
+/// reachable from here, there are no other loops to hand it to.
+/// </summary>
+void SharedLoop::FanOut(const MsgRef& msg, SharedSession* pSender)
+{
+  std::shared_lock<std::shared_mutex> lock(m_sessionsMutex);
+  for (const auto& kv : m_sessions)
+  {
+    SharedSession* s = kv.second.get();
+    if (s != pSender && !s->IsClosing())
+    {
+      s->PostSend(msg);
+    }
+  }
+}
+
+void SharedLoop::BroadcastMsg(const MsgRef& msg, SharedSession* pSender)
+{
+  m_stats.msgsIn.fetch_add(1, std::memory_order_relaxed);
+
+  FanOut(msg, pSender);
+
+  cout << "Message broadcasted:" << msg.View() << "\n";
+}
+
+void SharedLoop::FanOutPosted(const MsgRef& msg)
+{
+  FanOut(msg, nullptr);
+}
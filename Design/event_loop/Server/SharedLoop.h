@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <sys/epoll.h>   // epoll()
+
+#include "EpollTag.h"
+#include "LoopBase.h"
+#include "MsgBuf.h"
+#include "SharedSession.h"
+
+/// <summary>
+/// Shared-epoll worker pool: one epoll set, opts.workers threads all waiting on it.
+/// Clients are registered EPOLLONESHOT so an event is handled by one worker at a time
+/// and re-armed when it is done; listeners are edge-triggered.
+/// Second scaling model next to the sharded loops, every session is reachable
+/// from every worker and fan-out needs no cross-loop handoff.
+/// </summary>
+class SharedLoop : public LoopBase
+{
+public:
+  SharedLoop(ChatServer* server, size_t id);
+  ~SharedLoop() override;
+
+  bool Init(const std::vector<int>& listenSockets) override;
+  void Run() override;
+  size_t Workers() const override { return m_opts.workers; }
+
+  void BroadcastMsg(const MsgRef& msg, SharedSession* pSender);
+  bool CtlEpoll(int op, int fd, uint32_t events, uint64_t tag);
+
+protected:
+  void FanOutPosted(const MsgRef& msg) override;
+
+private:
+  void HandleListener(int sfd, uint32_t event);
+  void HandleClient(const EpollTag& tag, uint32_t event, BufPool& pool);
+
+  void AcceptAll(int sfd);
+  void CloseSession(const std::shared_ptr<SharedSession>& sess);
+  void FanOut(const MsgRef& msg, SharedSession* pSender);
+  std::shared_ptr<SharedSession> Find(const EpollTag& tag);
+
+private:
+  int m_epoll = -1;
+  std::vector<int> m_listenSockets;
+
+  // Worker i receives into m_pools[i], Run() hands out the indices
+  std::vector<BufPool*> m_pools;
+  std::atomic<size_t> m_nextWorker{0};
+
+  // Accept and close take it exclusively, event lookup and fan-out shared.
+  // A handling worker holds its own reference, so a session closed by one
+  // worker is freed (and its fd number reused) only once no worker uses it.
+  std::shared_mutex m_sessionsMutex;
+  std::unordered_map<int, std::shared_ptr<SharedSession>> m_sessions;
+  std::atomic<uint32_t> m_nextGen{0};
+};
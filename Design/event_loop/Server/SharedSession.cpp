@@ -0,0 +1,346 @@
+#include "SharedSession.h"
+#include "SharedLoop.h"
+#include "BufPool.h"
+#include "EpollTag.h"
+
+#include <sys/socket.h> // recv(), send(), sendmsg(), shutdown()
+#include <sys/uio.h>    // iovec
+#include <sys/epoll.h>  // EPOLL*
+#include <unistd.h>     // close()
+#include <climits>      // IOV_MAX
+#include <cstdio>
+#include <cerrno>
+
+constexpr size_t SEND_IOV_MAX = IOV_MAX; // msgs gathered per sendmsg()
+
+//
+// === SharedSession functions ===
+//
+
+SharedSession::SharedSession(int socket, uint32_t gen, SharedLoop* loop)
+  : m_socket(socket), m_gen(gen), m_loop(loop) {}
+
+SharedSession::~SharedSession()
+{
+  // Last reference is gone, no worker can touch the fd number anymore
+  m_loop->GetStats().queuedBytes.fetch_sub(m_queuedBytes, std::memory_order_relaxed);
+
+  if (m_socket != -1)
+  {
+    close(m_socket);
+    m_socket = -1;
+  }
+}
+
+/// <summary>
+/// Sets closing and drops the queue. Returns false if the session was already closing,
+/// so of several workers racing to close it only one goes on.
+/// </summary>
+bool SharedSession::MarkClosing()
+{
+  std::lock_guard<std::mutex> lg(m_sendMutex);
+  if (m_closing.exchange(true, std::memory_order_acq_rel))
+    return false;
+
+  m_loop->GetStats().queuedBytes.fetch_sub(m_queuedBytes, std::memory_order_relaxed);
+  m_sendQueue.clear();
+  m_queuedBytes = 0;
+  m_sendOffset = 0;
+  return true;
+}
+
+bool SharedSession::Read(BufPool& pool)
+{
+  // Held across the fan-out: a second worker woken for this session waits here
+  std::lock_guard<std::mutex> lg(m_readMutex);
+
+  while (true)
+  {
+    // recv straight into the payload every recipient will share
+    MsgBuf* buf = pool.Acquire(m_recvClass);
+    ssize_t bytes = recv(m_socket, buf->MutableData(), buf->Capacity(), 0);
+
+    if (bytes <= 0)
+    {
+      pool.Giveback(buf);
+    }
+
+    // peer closed connection
+    if (bytes == 0) return false;
+
+    // Error occured
+    if (bytes < 0)
+    {
+      // Stream of recv fully read
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        return true;
+      }
+
+      std::perror("recv");
+      return false;
+    }
+
+    buf->SetSize(static_cast<size_t>(bytes));
+    m_recvClass = static_cast<uint8_t>(BufPool::NextClass(m_recvClass, static_cast<size_t>(bytes)));
+
+    MsgRef msg(buf);
+    m_loop->BroadcastMsg(msg, this);
+  }
+}
+
+bool SharedSession::Write()
+{
+  std::lock_guard<std::mutex> lg(m_sendMutex);
+  return FlushLocked();
+}
+
+/// <summary>
+/// Sends as much of the queue as the socket takes. m_sendMutex must be held.
+/// </summary>
+bool SharedSession::FlushLocked()
+{
+  iovec iov[SEND_IOV_MAX];
+
+  while (!m_sendQueue.empty())
+  {
+    size_t cnt = 0;
+    size_t total = 0;
+    for (auto it = m_sendQueue.begin(); it != m_sendQueue.end() && cnt < SEND_IOV_MAX; ++it, ++cnt)
+    {
+      size_t offset = (cnt == 0) ? m_sendOffset : 0;
+      iov[cnt].iov_base = const_cast<char*>(it->Data() + offset);
+      iov[cnt].iov_len = it->Size() - offset;
+      total += iov[cnt].iov_len;
+    }
+
+    msghdr mh{};
+    mh.msg_iov = iov;
+    mh.msg_iovlen = cnt;
+    ssize_t bytes = sendmsg(m_socket, &mh, MSG_NOSIGNAL);
+    m_loop->GetStats().sendCalls.fetch_add(1, std::memory_order_relaxed);
+
+    // peer closed connection
+    if (bytes == 0) return false;
+
+    // Error occured
+    if (bytes < 0)
+    {
+      // Stream of recv fully read or try again later
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        return true;
+      }
+
+      std::perror("sendmsg");
+      return false;
+    }
+
+    ConsumeSentLocked(static_cast<size_t>(bytes));
+
+    // Kernel buffer is full
+    if (static_cast<size_t>(bytes) < total)
+    {
+      return true;
+    }
+  }
+
+  return true;
+}
+
+/// <summary>
+/// Pops fully sent messages and moves the offset cursor inside a partially sent one.
+/// </summary>
+void SharedSession::ConsumeSentLocked(size_t bytes)
+{
+  while (bytes > 0 && !m_sendQueue.empty())
+  {
+    size_t left = m_sendQueue.front().Size() - m_sendOffset;
+    if (bytes < left)
+    {
+      m_sendOffset += bytes;
+      return;
+    }
+
+    // Drops this session's reference, last recipient frees the payload
+    bytes -= left;
+    size_t footprint = m_sendQueue.front().Footprint();
+    m_queuedBytes -= footprint;
+    m_loop->GetStats().queuedBytes.fetch_sub(footprint, std::memory_order_relaxed);
+    m_sendQueue.pop_front();
+    m_sendOffset = 0;
+  }
+}
+
+/// <summary>
+/// Queues a message from whichever worker fans it out. If the session is idle in
+/// epoll without write interest, it is re-armed for EPOLLOUT right here.
+/// </summary>
+void SharedSession::PostSend(const MsgRef& msg)
+{
+  if (msg.Size() == 0)
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lg(m_sendMutex);
+  if (m_overflowed || IsClosing())
+  {
+    return;
+  }
+
+  // Fast path: nothing queued and the kernel buffer usually has room
+  size_t offset = 0;
+  if (m_loop->GetOptions().inlineSend && m_sendQueue.empty())
+  {
+    ssize_t bytes = send(m_socket, msg.Data(), msg.Size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    m_loop->GetStats().sendCalls.fetch_add(1, std::memory_order_relaxed);
+    if (bytes == static_cast<ssize_t>(msg.Size()))
+    {
+      return;
+    }
+
+    // Partial send queues the rest, errors surface on the next event
+    if (bytes > 0)
+    {
+      offset = static_cast<size_t>(bytes);
+    }
+  }
+
+  // Once the peer has the start of a message the rest must follow,
+  // refusing it would leave the stream cut mid-message
+  size_t bytes = msg.Footprint();
+  if (offset == 0 && !AdmitSendLocked(bytes))
+  {
+    return;
+  }
+
+  m_sendQueue.push_back(msg);
+  if (m_sendQueue.size() == 1)
+  {
+    m_sendOffset = offset;
+  }
+  m_queuedBytes += bytes;
+  m_loop->GetStats().queuedBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+  // A worker handling the session re-arms it anyway. Arming twice at worst
+  // wakes a second worker, which waits on the session's locks.
+  if (!(m_armed & EPOLLOUT))
+  {
+    ArmLocked(EPOLL_CTL_MOD);
+  }
+}
+
+/// <summary>
+/// First registration, done by the accepting worker before anyone else can see the session.
+/// </summary>
+bool SharedSession::Register()
+{
+  std::lock_guard<std::mutex> lg(m_sendMutex);
+  return ArmLocked(EPOLL_CTL_ADD);
+}
+
+bool SharedSession::Rearm()
+{
+  std::lock_guard<std::mutex> lg(m_sendMutex);
+  if (IsClosing())
+    return true;
+
+  return ArmLocked(EPOLL_CTL_MOD);
+}
+
+bool SharedSession::ArmLocked(int op)
+{
+  uint32_t mask = EPOLLIN | EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
+  if (!m_sendQueue.empty())
+  {
+    mask |= EPOLLOUT;
+  }
+
+  if (!m_loop->CtlEpoll(op, m_socket, mask, EpollTag::Pack(FdKind::Client, m_socket, m_gen)))
+  {
+    return false;
+  }
+
+  m_armed = mask;
+  return true;
+}
+
+/// <summary>
+/// Applies the send queue bounds to a message of the given footprint about to be queued.
+/// Returns false if it must not be queued.
+/// </summary>
+bool SharedSession::AdmitSendLocked(size_t bytes)
+{
+  const ServerOptions& opts = m_loop->GetOptions();
+  if (opts.txHwm == 0)
+    return true;
+
+  LoopStats& stats = m_loop->GetStats();
+
+  // Hysteresis: once shedding, stay so until the reader has caught up
+  if (m_shedding)
+  {
+    if (m_queuedBytes > opts.txLwm)
+    {
+      stats.txDropNewest.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    m_shedding = false;
+  }
+
+  // An empty queue takes any one message, or one bigger than the HWM would never go out
+  if (m_queuedBytes == 0 || m_queuedBytes + bytes <= opts.txHwm)
+    return true;
+
+  switch (opts.txOverflow)
+  {
+    case TxOverflowMode::DropNewest:
+      m_shedding = true;
+      stats.txDropNewest.fetch_add(1, std::memory_order_relaxed);
+      return false;
+
+    case TxOverflowMode::DropOldest:
+      DropOldestLocked(opts.txLwm > bytes ? opts.txLwm - bytes : 0);
+      if (m_queuedBytes + bytes <= opts.txHwm)
+        return true;
+
+      // Whatever is left is already being sent
+      stats.txDropNewest.fetch_add(1, std::memory_order_relaxed);
+      return false;
+
+    case TxOverflowMode::DisconnectOnOverflow:
+    default:
+      // The hangup this raises closes it from whichever worker gets the event
+      m_overflowed = true;
+      stats.queuedBytes.fetch_sub(m_queuedBytes, std::memory_order_relaxed);
+      m_sendQueue.clear();
+      m_queuedBytes = 0;
+      m_sendOffset = 0;
+      shutdown(m_socket, SHUT_RDWR);
+      stats.txDisconnects.fetch_add(1, std::memory_order_relaxed);
+      return false;
+  }
+}
+
+/// <summary>
+/// Evicts queued messages from the front until at most target bytes are queued.
+/// A partially sent front message stays.
+/// </summary>
+void SharedSession::DropOldestLocked(size_t target)
+{
+  auto first = m_sendQueue.begin() + (m_sendOffset > 0 ? 1 : 0);
+  auto last = first;
+  size_t freed = 0;
+  while (last != m_sendQueue.end() && m_queuedBytes - freed > target)
+  {
+    freed += last->Footprint();
+    ++last;
+  }
+
+  LoopStats& stats = m_loop->GetStats();
+  stats.txDropOldest.fetch_add(static_cast<uint64_t>(last - first), std::memory_order_relaxed);
+  stats.queuedBytes.fetch_sub(freed, std::memory_order_relaxed);
+  m_queuedBytes -= freed;
+  m_sendQueue.erase(first, last);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "MsgBuf.h"
+
+class SharedLoop;
+class BufPool;
+
+/// <summary>
+/// Client session for the shared-epoll worker pool, where whichever worker gets the
+/// event handles it. State is split by who may touch it:
+/// - read side (recv, broadcast) is serialized by m_readMutex, held across recv and
+///   fan-out so one sender's chunks go out in the order they were read;
+/// - send side (queue, armed epoll interest) is guarded by m_sendMutex, taken by the
+///   worker handling the event and by every worker fanning out to the session.
+///   It is a leaf lock, nothing else is acquired while holding it.
+/// </summary>
+class SharedSession
+{
+public:
+  SharedSession(int socket, uint32_t gen, SharedLoop* loop);
+  ~SharedSession();
+
+  bool Read(BufPool& pool);
+  bool Write();
+  void PostSend(const MsgRef& msg);
+
+  bool Register();
+  // Re-arms the ONESHOT registration, after every handled event
+  bool Rearm();
+  // Stops further fan-out to the session, the handling worker closes it
+  bool MarkClosing();
+
+  int GetSocket() const { return m_socket; }
+  uint32_t GetGen() const { return m_gen; }
+  bool IsClosing() const { return m_closing.load(std::memory_order_acquire); }
+
+private:
+  bool FlushLocked();
+  bool ArmLocked(int op);
+  bool AdmitSendLocked(size_t bytes);
+  void DropOldestLocked(size_t target);
+  void ConsumeSentLocked(size_t bytes);
+
+private:
+  int m_socket = -1;
+  uint32_t m_gen = 0;
+  SharedLoop* m_loop = nullptr;
+  std::atomic<bool> m_closing{false};
+
+  // Read side
+  std::mutex m_readMutex;
+  uint8_t m_recvClass = 0;
+
+  // Send side. Front message is sent from m_sendOffset.
+  std::mutex m_sendMutex;
+  std::deque<MsgRef> m_sendQueue;
+  size_t m_sendOffset = 0;
+  size_t m_queuedBytes = 0;
+  uint32_t m_armed = 0;     // mask last armed; stale once ONESHOT fired, the handler re-arms
+  bool m_shedding = false;  // DropNewest: over the high watermark until drained to the low one
+  bool m_overflowed = false;
+};
@@ -0,0 +1,76 @@
+#include "SocketUtils.h"
+
+#include <iostream>
+
+#include <unistd.h>     // close()
+#include <netinet/in.h> // sockaddr_in, htons, htonl
+#include <arpa/inet.h>  // inet_ntop()
+#include <fcntl.h>      // fcntl()
+
+using std::cout;
+using std::cerr;
+
+/// <summary>
+/// Safely closes a socket and sets it to -1.
+/// </summary>
+/// <param name="s">Reference to a socket handle.</param>
+void SafeCloseSocket(int& socketfd)
+{
+  if (socketfd != -1) 
+  {
+    close(socketfd);
+    socketfd = -1;
+  }
+}
+
+/// <summary>
+/// Sets file descriptor to non-blocking mode.
+/// </summary>
+bool SetNonBlocking(int& sfd)
+{
+    int flags = fcntl(sfd, F_GETFL, 0);
+    if (flags == -1)
+    {
+      return false;
+    }
+
+    if (fcntl(sfd, F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+      return false;
+    }
+
+    return true;
+}
+
+/// <summary>
+/// prints a sockaddr (IPv4/IPv6) as "ip:port".
+/// </summary>
+/// <param name="addr">Pointer to a generic sockaddr.</param>
+void PrintSockaddr(const sockaddr* addr)
+{
+  char ipStr[INET6_ADDRSTRLEN] = {};
+  int port = 0;
+
+  if (addr->sa_family == AF_INET) // IPv4
+  {
+    const sockaddr_in* ipv4 = reinterpret_cast<const sockaddr_in*>(addr);
+    if (inet_ntop(AF_INET, &(ipv4->sin_addr), ipStr, sizeof(ipStr)))
+    {
+      port = ntohs(ipv4->sin_port);
+    }
+  }
+  else if (addr->sa_family == AF_INET6) // IPv6
+  {
+    const sockaddr_in6* ipv6 = reinterpret_cast<const sockaddr_in6*>(addr);
+    if (inet_ntop(AF_INET6, &(ipv6->sin6_addr), ipStr, sizeof(ipStr)))
+    {
+      port = ntohs(ipv6->sin6_port);
+    }
+  }
+  else
+  {
+    cerr << "Unknown address family\n";
+  }
+
+  cout << ipStr << ":" << port << "\n";
+}
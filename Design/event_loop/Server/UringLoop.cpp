@@ -0,0 +1,452 @@
+#include "UringLoop.h"
+#include "ChatServer.h"
+#include "SocketUtils.h"
+
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h> // send(), shutdown()
+#include <fcntl.h>      // fcntl()
+#include <unistd.h>     // close()
+
+using std::cout;
+using std::cerr;
+
+constexpr unsigned RING_ENTRIES = 4096;
+constexpr size_t ACCEPT_DEPTH = 16;       // accepts kept posted per listener
+constexpr long BACKLOG_RETRY_NS = 1000000; // 1 ms, same as the epoll loop timeout
+
+//
+// === UringLoop functions ===
+//
+
+UringLoop::UringLoop(ChatServer* server, size_t id)
+  : LoopBase(server, id)
+{
+  m_opWakeup.kind = UringOp::Kind::Wakeup;
+  m_opTimer.kind = UringOp::Kind::Timer;
+}
+
+UringLoop::~UringLoop()
+{
+  // Run() drained its operations, the ring can go first
+  m_ring.Close();
+
+  // Close clients
+  m_clients.Clear();
+
+  // Close listeners
+  for (auto& s : m_listenSockets)
+  {
+    SafeCloseSocket(s);
+  }
+  m_listenSockets.clear();
+  m_accepts.clear();
+}
+
+/// <summary>
+/// Takes ownership of the listening sockets, sets up the ring,
+/// pre-posts accepts and the wakeup read.
+/// </summary>
+bool UringLoop::Init(const std::vector<int>& listenSockets)
+{
+  m_listenSockets = listenSockets;
+  // Any fd may land in this loop, but the sessions are split among the loops
+  m_clients.Reserve(m_opts.prewarm, (m_opts.prewarm + m_opts.loops - 1) / m_opts.loops);
+
+  // Ring parks accepts itself, listeners come non-blocking for the epoll loop
+  for (int lsfd : m_listenSockets)
+  {
+    int flags = fcntl(lsfd, F_GETFL, 0);
+    if (flags != -1)
+      fcntl(lsfd, F_SETFL, flags & ~O_NONBLOCK);
+  }
+
+  if (!m_ring.Init(RING_ENTRIES))
+  {
+    return false;
+  }
+
+  // Blocking eventfd: the ring waits on it, not the loop
+  if (!InitWakeup(0) || !PostWakeupRead())
+  {
+    return false;
+  }
+
+  for (int lsfd : m_listenSockets)
+  {
+    for (size_t i = 0; i < ACCEPT_DEPTH; ++i)
+    {
+      auto ctx = std::make_unique<UringAcceptCtx>();
+      ctx->op.kind = UringOp::Kind::Accept;
+      ctx->listenSock = lsfd;
+      if (!PostAccept(ctx.get()))
+      {
+        return false;
+      }
+      m_accepts.push_back(std::move(ctx));
+    }
+  }
+
+  m_running.store(true, std::memory_order_release);
+  return true;
+}
+
+/// <summary>
+/// Submits what handlers queued, waits for completions and dispatches them.
+/// </summary>
+void UringLoop::Run()
+{
+  while (m_running.load(std::memory_order_acquire))
+  {
+    FlushBacklog();
+    if (HasBacklog() || !m_parkedAccepts.empty())
+    {
+      ArmBacklogTimer();
+    }
+
+    int ret = m_ring.Submit(1);
+    if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY)
+    {
+      errno = -ret;
+      perror("io_uring_enter");
+      break;
+    }
+
+    m_ring.ForEachCqe([this](const io_uring_cqe& cqe) { Dispatch(cqe); });
+  }
+
+  Drain();
+}
+
+//
+// === Completion handlers ===
+//
+
+void UringLoop::Dispatch(const io_uring_cqe& cqe)
+{
+  --m_opsInFlight;
+  m_stats.events.fetch_add(1, std::memory_order_relaxed);
+
+  UringOp* op = reinterpret_cast<UringOp*>(cqe.user_data);
+  switch (op->kind)
+  {
+    case UringOp::Kind::Accept:
+      OnAccept(reinterpret_cast<UringAcceptCtx*>(op), cqe.res);
+      break;
+
+    case UringOp::Kind::Recv:
+      OnRecv(op->sess, cqe.res);
+      break;
+
+    case UringOp::Kind::Send:
+      OnSend(op->sess, cqe.res);
+      break;
+
+    case UringOp::Kind::Wakeup:
+      OnWakeup(cqe.res);
+      break;
+
+    case UringOp::Kind::Timer:
+      m_timerArmed = false;
+      RepostParkedAccepts();
+      break;
+
+    default: break;
+  }
+}
+
+void UringLoop::OnAccept(UringAcceptCtx* ctx, int res)
+{
+  if (!m_running.load(std::memory_order_acquire))
+  {
+    if (res >= 0) close(res);
+    return;
+  }
+
+  if (res < 0)
+  {
+    // Out of fds or memory: reposting now would fail again straight away and spin
+    // the ring, so the accept waits for the retry tick. Logged once per stall.
+    if (res == -EMFILE || res == -ENFILE || res == -ENOBUFS || res == -ENOMEM)
+    {
+      if (!m_acceptStalled)
+      {
+        errno = -res;
+        perror("accept");
+        m_acceptStalled = true;
+      }
+      m_parkedAccepts.push_back(ctx);
+      return;
+    }
+
+    if (res != -EINTR && res != -ECONNABORTED)
+    {
+      errno = -res;
+      perror("accept");
+    }
+    PostAccept(ctx);
+    return;
+  }
+
+  int cs = res;
+  m_acceptStalled = false;
+
+  // Optional greeting
+  static const char* hello = "Welcome to the chat!\n";
+  send(cs, hello, strlen(hello), MSG_NOSIGNAL | MSG_DONTWAIT);
+
+  UringSession* sess = m_clients.Emplace(cs, cs, this);
+  if (sess == nullptr)
+  {
+    close(cs);
+    PostAccept(ctx);
+    return;
+  }
+  m_stats.accepts.fetch_add(1, std::memory_order_relaxed);
+
+  // Peer address came with the completion
+  cout << "Client connected to loop " << m_id << ": ";
+  PrintSockaddr(reinterpret_cast<sockaddr*>(&ctx->addr));
+
+  if (!sess->PostRecv())
+  {
+    CloseSession(sess);
+    ReleaseIfIdle(sess);
+  }
+
+  // Keep the accept pool full
+  PostAccept(ctx);
+}
+
+void UringLoop::OnRecv(UringSession* sess, int res)
+{
+  --sess->m_opsInFlight;
+
+  if (res <= 0 || sess->m_closing || !m_running.load(std::memory_order_acquire))
+  {
+    CloseSession(sess);
+    ReleaseIfIdle(sess);
+    return;
+  }
+
+  MsgRef msg = sess->TakeRecv(static_cast<size_t>(res));
+  BroadcastMsg(msg, sess);
+
+  if (!sess->PostRecv())
+  {
+    CloseSession(sess);
+  }
+  ReleaseIfIdle(sess);
+}
+
+void UringLoop::OnSend(UringSession* sess, int res)
+{
+  --sess->m_opsInFlight;
+  sess->m_sendInFlight = false;
+
+  if (res < 0)
+  {
+    CloseSession(sess);
+  }
+  else
+  {
+    sess->ConsumeSent(static_cast<size_t>(res));
+    if (!sess->m_closing)
+    {
+      sess->PostNextSend();
+    }
+  }
+
+  ReleaseIfIdle(sess);
+}
+
+/// <summary>
+/// Another loop posted messages or Stop() was called.
+/// </summary>
+void UringLoop::OnWakeup(int res)
+{
+  if (!m_running.load(std::memory_order_acquire))
+    return;
+
+  if (res < 0 && res != -EINTR)
+  {
+    errno = -res;
+    perror("eventfd read");
+  }
+
+  DrainInbox();
+  PostWakeupRead();
+}
+
+//
+// === Submission helpers ===
+//
+
+io_uring_sqe* UringLoop::GetSqe(UringOp* op)
+{
+  io_uring_sqe* sqe = m_ring.GetSqe();
+  if (sqe == nullptr)
+  {
+    cerr << "Loop " << m_id << " submission queue is full\n";
+    return nullptr;
+  }
+
+  sqe->user_data = reinterpret_cast<uint64_t>(op);
+  ++m_opsInFlight;
+  return sqe;
+}
+
+bool UringLoop::PostAccept(UringAcceptCtx* ctx)
+{
+  io_uring_sqe* sqe = GetSqe(&ctx->op);
+  if (sqe == nullptr)
+    return false;
+
+  ctx->addrLen = sizeof(ctx->addr);
+  memset(&ctx->addr, 0, sizeof(ctx->addr));
+
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = ctx->listenSock;
+  sqe->addr = reinterpret_cast<uint64_t>(&ctx->addr);
+  sqe->addr2 = reinterpret_cast<uint64_t>(&ctx->addrLen);
+  sqe->accept_flags = SOCK_CLOEXEC;
+  return true;
+}
+
+bool UringLoop::PostWakeupRead()
+{
+  io_uring_sqe* sqe = GetSqe(&m_opWakeup);
+  if (sqe == nullptr)
+    return false;
+
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = m_wakeFd;
+  sqe->addr = reinterpret_cast<uint64_t>(&m_wakeCounter);
+  sqe->len = sizeof(m_wakeCounter);
+  return true;
+}
+
+/// <summary>
+/// One-shot timeout, so Run() wakes up to retry the backlog like the epoll loop's 1 ms timeout.
+/// </summary>
+void UringLoop::ArmBacklogTimer()
+{
+  if (m_timerArmed)
+    return;
+
+  io_uring_sqe* sqe = GetSqe(&m_opTimer);
+  if (sqe == nullptr)
+    return;
+
+  m_timerTs.tv_sec = 0;
+  m_timerTs.tv_nsec = BACKLOG_RETRY_NS;
+
+  sqe->opcode = IORING_OP_TIMEOUT;
+  sqe->addr = reinterpret_cast<uint64_t>(&m_timerTs);
+  sqe->len = 1;
+  m_timerArmed = true;
+}
+
+void UringLoop::RepostParkedAccepts()
+{
+  if (!m_running.load(std::memory_order_acquire))
+    return;
+
+  std::vector<UringAcceptCtx*> parked;
+  parked.swap(m_parkedAccepts);
+  for (UringAcceptCtx* ctx : parked)
+  {
+    if (!PostAccept(ctx))
+    {
+      m_parkedAccepts.push_back(ctx);
+    }
+  }
+}
+
+//
+// === Sessions ===
+//
+
+void UringLoop::CloseSession(UringSession* sess)
+{
+  sess->Shutdown();
+}
+
+/// <summary>
+/// Destroys a closing session once the kernel returned all its operations,
+/// so neither its buffers nor its fd number can be reused under them.
+/// </summary>
+void UringLoop::ReleaseIfIdle(UringSession* sess)
+{
+  if (sess->m_closing && sess->IsIdle())
+  {
+    m_clients.Erase(sess->GetSocket());
+    m_stats.closes.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/// <summary>
+/// Queues the message to every local session except the sender.
+/// Sessions only take a reference, payload bytes are never copied.
+/// </summary>
+void UringLoop::FanOut(const MsgRef& msg, UringSession* pSender)
+{
+  for (UringSession* s : m_clients.Live())
+  {
+    if (s != pSender)
+    {
+      s->PostSend(msg);
+    }
+  }
+}
+
+/// <summary>
+/// Broadcasts a message received by a local session to every client on every loop.
+/// </summary>
+void UringLoop::BroadcastMsg(const MsgRef& msg, UringSession* pSender)
+{
+  m_stats.msgsIn.fetch_add(1, std::memory_order_relaxed);
+
+  FanOut(msg, pSender);
+  m_server->BroadcastMsg(msg, this);
+
+  cout << "Message broadcasted:" << msg.View() << "\n";
+}
+
+void UringLoop::FanOutPosted(const MsgRef& msg)
+{
+  FanOut(msg, nullptr);
+}
+
+/// <summary>
+/// Stops listeners and sessions, then reaps completions until the kernel
+/// holds no more pointers into this loop's memory.
+/// </summary>
+void UringLoop::Drain()
+{
+  // Pending accepts fail once the listener is shut down
+  for (int lsfd : m_listenSockets)
+  {
+    shutdown(lsfd, SHUT_RDWR);
+  }
+
+  for (UringSession* s : m_clients.Live())
+  {
+    s->Shutdown();
+  }
+
+  // Wakeup read stays outstanding until Stop() writes the eventfd
+  Wakeup();
+
+  while (m_opsInFlight > 0)
+  {
+    int ret = m_ring.Submit(1);
+    if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY)
+    {
+      break;
+    }
+    m_ring.ForEachCqe([this](const io_uring_cqe& cqe) { Dispatch(cqe); });
+  }
+}
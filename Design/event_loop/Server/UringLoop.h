@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <sys/socket.h> // sockaddr_storage
+
+#include "IoUring.h"
+#include "LoopBase.h"
+#include "MsgBuf.h"
+#include "SessionSlab.h"
+#include "UringSession.h"
+
+/// <summary>
+/// Pre-posted accept on a listener, reposted on every completion.
+/// op must stay the first member: completions are dispatched through it.
+/// </summary>
+struct UringAcceptCtx
+{
+  UringOp op;
+  int listenSock = -1;
+  sockaddr_storage addr;
+  socklen_t addrLen = 0;
+};
+
+/// <summary>
+/// io_uring proactor, counterpart of the IOCP server: accepts are pre-posted,
+/// every session keeps a recv outstanding and sends are driven by completions.
+/// Shares listeners, sharding and cross-loop handoff with the epoll loop.
+/// </summary>
+class UringLoop : public LoopBase
+{
+public:
+  UringLoop(ChatServer* server, size_t id);
+  ~UringLoop() override;
+
+  bool Init(const std::vector<int>& listenSockets) override;
+  void Run() override;
+
+  void BroadcastMsg(const MsgRef& msg, UringSession* pSender);
+
+  // SQE tagged with op and counted as in flight until its completion is reaped
+  io_uring_sqe* GetSqe(UringOp* op);
+
+protected:
+  void FanOutPosted(const MsgRef& msg) override;
+
+private:
+  void Dispatch(const io_uring_cqe& cqe);
+  void OnAccept(UringAcceptCtx* ctx, int res);
+  void OnRecv(UringSession* sess, int res);
+  void OnSend(UringSession* sess, int res);
+  void OnWakeup(int res);
+
+  bool PostAccept(UringAcceptCtx* ctx);
+  bool PostWakeupRead();
+  void ArmBacklogTimer();
+  void RepostParkedAccepts();
+
+  void CloseSession(UringSession* sess);
+  void ReleaseIfIdle(UringSession* sess);
+  void FanOut(const MsgRef& msg, UringSession* pSender);
+  void Drain();
+
+private:
+  IoUring m_ring;
+  unsigned m_opsInFlight = 0;
+
+  std::vector<int> m_listenSockets;
+  std::vector<std::unique_ptr<UringAcceptCtx>> m_accepts;
+  // Accepts that failed for lack of fds or memory, reposted on the retry tick
+  std::vector<UringAcceptCtx*> m_parkedAccepts;
+  bool m_acceptStalled = false; // logged, cleared by the next accepted client
+  SessionSlab<UringSession> m_clients;
+
+  // Read kept outstanding on the wakeup eventfd
+  UringOp m_opWakeup;
+  uint64_t m_wakeCounter = 0;
+
+  // Retry tick while other loops' inboxes are full or accepts are parked
+  UringOp m_opTimer;
+  __kernel_timespec m_timerTs{};
+  bool m_timerArmed = false;
+};
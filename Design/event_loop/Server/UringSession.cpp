@@ -0,0 +1,229 @@
+#include "UringSession.h"
+#include "UringLoop.h"
+#include "BufPool.h"
+
+#include <cstring>
+
+#include <unistd.h>     // close()
+
+//
+// === UringSession functions ===
+//
+
+UringSession::UringSession(int socket, UringLoop* loop)
+  : m_socket(socket), m_loop(loop)
+{
+  m_opRecv.kind = UringOp::Kind::Recv;
+  m_opRecv.sess = this;
+  m_opSend.kind = UringOp::Kind::Send;
+  m_opSend.sess = this;
+  memset(&m_msg, 0, sizeof(m_msg));
+}
+
+UringSession::~UringSession()
+{
+  // Loop erases sessions only once no recv is outstanding
+  if (m_recvBuf != nullptr)
+  {
+    m_loop->GetBufPool().Giveback(m_recvBuf);
+    m_recvBuf = nullptr;
+  }
+
+  if (m_socket != -1)
+  {
+    close(m_socket);
+    m_socket = -1;
+  }
+}
+
+/// <summary>
+/// Stops further I/O. Outstanding recv/send complete with 0 or an error,
+/// the loop destroys the session (and closes the socket) once they are all back.
+/// </summary>
+void UringSession::Shutdown()
+{
+  if (m_closing)
+    return;
+
+  m_closing = true;
+  shutdown(m_socket, SHUT_RDWR);
+}
+
+bool UringSession::PostRecv()
+{
+  io_uring_sqe* sqe = m_loop->GetSqe(&m_opRecv);
+  if (sqe == nullptr)
+    return false;
+
+  if (m_recvBuf == nullptr)
+  {
+    m_recvBuf = m_loop->GetBufPool().Acquire(m_recvClass);
+  }
+
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = m_socket;
+  sqe->addr = reinterpret_cast<uint64_t>(m_recvBuf->MutableData());
+  sqe->len = static_cast<uint32_t>(m_recvBuf->Capacity());
+  ++m_opsInFlight;
+  return true;
+}
+
+/// <summary>
+/// Turns the buffer the completed recv filled into a shared payload.
+/// </summary>
+MsgRef UringSession::TakeRecv(size_t bytes)
+{
+  MsgBuf* buf = m_recvBuf;
+  m_recvBuf = nullptr;
+
+  buf->SetSize(bytes);
+  m_recvClass = BufPool::NextClass(m_recvClass, bytes);
+  return MsgRef(buf);
+}
+
+void UringSession::PostSend(const MsgRef& msg)
+{
+  if (m_closing || msg.Size() == 0)
+    return;
+
+  if (!AdmitSend(msg.Footprint()))
+    return;
+
+  m_sendQueue.push_back(msg);
+  m_queuedBytes += msg.Footprint();
+  if (!m_sendInFlight)
+  {
+    PostNextSend();
+  }
+}
+
+/// <summary>
+/// Gathers the head of the send queue into one sendmsg. Returns false if nothing was posted.
+/// </summary>
+bool UringSession::PostNextSend()
+{
+  if (m_sendInFlight || m_sendQueue.empty())
+    return false;
+
+  size_t cnt = 0;
+  for (auto it = m_sendQueue.begin(); it != m_sendQueue.end() && cnt < SEND_IOV; ++it, ++cnt)
+  {
+    size_t offset = (cnt == 0) ? m_sendOffset : 0;
+    m_iov[cnt].iov_base = const_cast<char*>(it->Data() + offset);
+    m_iov[cnt].iov_len = it->Size() - offset;
+  }
+
+  memset(&m_msg, 0, sizeof(m_msg));
+  m_msg.msg_iov = m_iov;
+  m_msg.msg_iovlen = cnt;
+
+  io_uring_sqe* sqe = m_loop->GetSqe(&m_opSend);
+  if (sqe == nullptr)
+    return false;
+
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = m_socket;
+  sqe->addr = reinterpret_cast<uint64_t>(&m_msg);
+  sqe->len = 1;
+  sqe->msg_flags = MSG_NOSIGNAL;
+
+  m_sendInFlight = true;
+  ++m_opsInFlight;
+  return true;
+}
+
+/// <summary>
+/// Pops fully sent messages and moves the offset cursor inside a partially sent one.
+/// </summary>
+void UringSession::ConsumeSent(size_t bytes)
+{
+  while (bytes > 0 && !m_sendQueue.empty())
+  {
+    size_t left = m_sendQueue.front().Size() - m_sendOffset;
+    if (bytes < left)
+    {
+      m_sendOffset += bytes;
+      return;
+    }
+
+    // Drops this session's reference, last recipient frees the payload
+    bytes -= left;
+    m_queuedBytes -= m_sendQueue.front().Footprint();
+    m_sendQueue.pop_front();
+    m_sendOffset = 0;
+  }
+}
+
+/// <summary>
+/// Applies the send queue bounds to a message of the given footprint about to be queued.
+/// Returns false if it must not be queued.
+/// </summary>
+bool UringSession::AdmitSend(size_t bytes)
+{
+  const ServerOptions& opts = m_loop->GetOptions();
+  if (opts.txHwm == 0)
+    return true;
+
+  LoopStats& stats = m_loop->GetStats();
+
+  // Hysteresis: once shedding, stay so until the reader has caught up
+  if (m_shedding)
+  {
+    if (m_queuedBytes > opts.txLwm)
+    {
+      stats.txDropNewest.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    m_shedding = false;
+  }
+
+  // An empty queue takes any one message, or one bigger than the HWM would never go out
+  if (m_queuedBytes == 0 || m_queuedBytes + bytes <= opts.txHwm)
+    return true;
+
+  switch (opts.txOverflow)
+  {
+    case TxOverflowMode::DropNewest:
+      m_shedding = true;
+      stats.txDropNewest.fetch_add(1, std::memory_order_relaxed);
+      return false;
+
+    case TxOverflowMode::DropOldest:
+      DropOldest(opts.txLwm > bytes ? opts.txLwm - bytes : 0);
+      if (m_queuedBytes + bytes <= opts.txHwm)
+        return true;
+
+      // Whatever is left is already being sent
+      stats.txDropNewest.fetch_add(1, std::memory_order_relaxed);
+      return false;
+
+    case TxOverflowMode::DisconnectOnOverflow:
+    default:
+      // Outstanding ops complete with errors and the loop releases the session
+      Shutdown();
+      stats.txDisconnects.fetch_add(1, std::memory_order_relaxed);
+      return false;
+  }
+}
+
+/// <summary>
+/// Evicts queued messages from the front until at most target bytes are queued.
+/// Messages the in-flight sendmsg gathers, or a partially sent front one, stay.
+/// </summary>
+void UringSession::DropOldest(size_t target)
+{
+  size_t keep = m_sendInFlight ? m_msg.msg_iovlen : (m_sendOffset > 0 ? 1 : 0);
+  if (keep >= m_sendQueue.size())
+    return;
+
+  auto first = m_sendQueue.begin() + static_cast<std::ptrdiff_t>(keep);
+  auto last = first;
+  while (last != m_sendQueue.end() && m_queuedBytes > target)
+  {
+    m_queuedBytes -= last->Footprint();
+    ++last;
+  }
+
+  m_loop->GetStats().txDropOldest.fetch_add(static_cast<uint64_t>(last - first), std::memory_order_relaxed);
+  m_sendQueue.erase(first, last);
+}
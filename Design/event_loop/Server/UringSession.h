@@ -0,0 +1,73 @@
+#pragma once
+
+#include <deque>
+#include <cstdint>
+
+#include <sys/socket.h> // msghdr
+#include <sys/uio.h>    // iovec
+
+#include "MsgBuf.h"
+
+class UringLoop;
+class UringSession;
+
+/// <summary>
+/// Discriminated io_uring user_data to know which operation completed.
+/// </summary>
+struct UringOp
+{
+  enum class Kind : uint8_t { Accept, Recv, Send, Wakeup, Timer } kind{};
+  UringSession* sess = nullptr;
+};
+
+/// <summary>
+/// Client session for the io_uring proactor: a recv is always outstanding,
+/// at most one gathered sendmsg is in flight and the rest waits in the send queue.
+/// </summary>
+class UringSession
+{
+public:
+  static constexpr size_t SEND_IOV = 64;
+
+  UringSession(int socket, UringLoop* loop);
+  ~UringSession();
+
+  bool PostRecv();
+  MsgRef TakeRecv(size_t bytes);
+  void PostSend(const MsgRef& msg);
+  bool PostNextSend();
+  void ConsumeSent(size_t bytes);
+  void Shutdown();
+
+  int GetSocket() const { return m_socket; }
+  bool IsIdle() const { return m_opsInFlight == 0; }
+
+  // Exposed to loop's completion dispatch:
+  UringOp m_opRecv;
+  UringOp m_opSend;
+  unsigned m_opsInFlight = 0;
+  bool m_sendInFlight = false;
+  bool m_closing = false;
+
+private:
+  bool AdmitSend(size_t bytes);
+  void DropOldest(size_t target);
+
+private:
+  int m_socket = -1;
+  UringLoop* m_loop = nullptr;
+
+  // Pooled buffer the outstanding recv fills, shared as the payload on completion
+  MsgBuf* m_recvBuf = nullptr;
+  size_t m_recvClass = 0;
+
+  // Shared payloads, front one is sent from m_sendOffset
+  std::deque<MsgRef> m_sendQueue;
+  size_t m_sendOffset = 0;
+  size_t m_queuedBytes = 0; // buffer bytes the queue pins (Footprint()), checked against the watermarks
+  bool m_shedding = false;  // DropNewest: over the high watermark until drained to the low one
+
+  // Must stay valid until the sendmsg completes
+  iovec m_iov[SEND_IOV];
+  msghdr m_msg;
+};
@@ -0,0 +1,115 @@
+#include "ByteRing.h"
+
+#include <cstring>
+
+//
+// === ByteRing functions ===
+//
+
+void ByteRing::Append(const char* data, size_t len)
+{
+  if (len == 0)
+    return;
+
+  if (Size() + len > m_capacity)
+  {
+    Grow(len);
+  }
+
+  // Copy up to the physical end, then wrap
+  size_t mask = m_capacity - 1;
+  size_t pos = m_tail & mask;
+  size_t first = m_capacity - pos;
+  if (first > len) first = len;
+
+  memcpy(m_buf.get() + pos, data, first);
+  memcpy(m_buf.get(), data + first, len - first);
+  m_tail += len;
+}
+
+/// <summary>
+/// Fills iov with the readable bytes in order. Returns 0, 1 or 2.
+/// </summary>
+size_t ByteRing::Peek(iovec iov[2]) const
+{
+  if (Empty())
+    return 0;
+
+  size_t mask = m_capacity - 1;
+  size_t pos = m_head & mask;
+  size_t size = Size();
+  size_t first = m_capacity - pos;
+  if (first > size) first = size;
+
+  iov[0].iov_base = m_buf.get() + pos;
+  iov[0].iov_len = first;
+  if (first == size)
+    return 1;
+
+  iov[1].iov_base = m_buf.get();
+  iov[1].iov_len = size - first;
+  return 2;
+}
+
+void ByteRing::Consume(size_t bytes)
+{
+  if (bytes > Size()) bytes = Size();
+  m_head += bytes;
+
+  // Drained: give the storage back
+  if (Empty())
+  {
+    m_buf.reset();
+    m_capacity = 0;
+    m_head = m_tail = 0;
+  }
+}
+
+/// <summary>
+/// Removes len bytes starting offset bytes past the head. The offset bytes in front
+/// are moved up to close the gap, so keep offset small.
+/// </summary>
+void ByteRing::Erase(size_t offset, size_t len)
+{
+  if (offset >= Size())
+    return;
+  if (len > Size() - offset) len = Size() - offset;
+
+  size_t mask = m_capacity - 1;
+  char* buf = m_buf.get();
+  for (size_t i = offset; i-- > 0; )
+  {
+    buf[(m_head + len + i) & mask] = buf[(m_head + i) & mask];
+  }
+
+  Consume(len);
+}
+
+/// <summary>
+/// Reallocates to the next power of two that fits need more bytes, unwrapping the content.
+/// </summary>
+void ByteRing::Grow(size_t need)
+{
+  size_t size = Size();
+  size_t capacity = m_capacity ? m_capacity : MIN_CAPACITY;
+  while (capacity < size + need)
+  {
+    capacity <<= 1;
+  }
+
+  std::unique_ptr<char[]> buf(new char[capacity]);
+
+  iovec iov[2];
+  size_t cnt = Peek(iov);
+  size_t off = 0;
+  for (size_t i = 0; i < cnt; ++i)
+  {
+    memcpy(buf.get() + off, iov[i].iov_base, iov[i].iov_len);
+    off += iov[i].iov_len;
+  }
+
+  m_buf = std::move(buf);
+  m_capacity = capacity;
+  m_head = 0;
+  m_tail = size;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <cstddef>
+
+#include <sys/uio.h>    // iovec
+
+/// <summary>
+/// Power-of-two byte ring for a session's outgoing bytes. Messages are copied in
+/// at the tail and flushed from the head with at most two iovecs, since the
+/// readable span wraps at most once. Grows by doubling and gives its storage
+/// back once drained, so idle sessions hold none.
+/// </summary>
+class ByteRing
+{
+public:
+  static constexpr size_t MIN_CAPACITY = 4096;
+
+  ByteRing() = default;
+
+  ByteRing(const ByteRing&) = delete;
+  ByteRing& operator=(const ByteRing&) = delete;
+
+  size_t Size() const { return m_tail - m_head; }
+  bool Empty() const { return m_tail == m_head; }
+
+  void Append(const char* data, size_t len);
+  size_t Peek(iovec iov[2]) const;
+  void Consume(size_t bytes);
+  void Erase(size_t offset, size_t len);
+
+private:
+  void Grow(size_t need);
+
+private:
+  std::unique_ptr<char[]> m_buf;
+  size_t m_capacity = 0;
+
+  // Free-running, masked with m_capacity - 1 on access
+  size_t m_head = 0;
+  size_t m_tail = 0;
+};
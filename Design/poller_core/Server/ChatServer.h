@@ -0,0 +1,588 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+#include <sys/socket.h> // socket(), bind(), listen(), accept()
+#include <sys/eventfd.h> // eventfd()
+#include <netdb.h>      // getaddrinfo(), freeaddrinfo()
+#include <unistd.h>     // read(), write()
+
+#include "Poller.h"
+#include "ClientSession.h"
+#include "SocketUtils.h"
+#include "SessionSlab.h"
+#include "EpollTag.h"
+
+/// <summary>
+/// Chat server core shared by every backend: accepts TCP connections, broadcasts
+/// incoming messages to the other clients and keeps each session's write interest
+/// in step with its send ring. Poller is a policy (see Poller.h) picked per build
+/// target, so the event loop calls it directly, with no virtual dispatch.
+/// Every fd is registered with an EpollTag and sessions live in a SessionSlab, so an
+/// event reaches its handler by tag kind and its session by fd index and generation.
+/// </summary>
+template <typename Poller>
+class ChatServer
+{
+public:
+  static constexpr int MAX_LISTEN = 64; // backlog (Num of clients)
+  static constexpr size_t SESSION_PREWARM = 1024; // session slots allocated before the first accept
+  static constexpr auto TX_REPORT_PERIOD = std::chrono::seconds(1); // slow reader counters are logged at most this often
+
+  ChatServer(const std::vector<std::string>& ips, const std::string& port);
+  ~ChatServer();
+
+  void Start();
+  void Stop();
+
+  // Safe from any thread and from a signal handler
+  void RequestStop();
+
+private:
+  int CreateListenSocket(const std::string& ip);
+  void RunLoop();
+  int WaitTimeout() const;
+  void Wakeup();
+
+  void HandleEvent(uint64_t data, uint32_t events);
+  void HandleWakeup();
+  void HandleListener(int sfd, uint32_t events);
+  void HandleClient(ClientSession* sess, uint32_t events);
+
+  void AcceptAll(int sfd);
+  void CloseClient(ClientSession* sess);
+  void BroadcastMsg(const std::string& msg, ClientSession* pSender);
+  void MarkDirty(ClientSession* sess);
+  void ApplyDirty();
+  void FlushClosed();
+  void ReportTxStats();
+
+private:
+  std::atomic<bool> m_running{false};
+  std::string m_port;
+  std::vector<std::string> m_ips;
+
+  Poller m_poller;
+  // Signalled by RequestStop(), so the poller can wait without a timeout. Every
+  // broadcast is queued by the loop thread itself, stop is the only cross-thread request
+  int m_wakeFd = -1;
+  std::vector<int> m_listenSockets;
+
+  SessionSlab<ClientSession> m_sessions;
+
+  // Sessions whose write interest may have changed this round
+  std::vector<ClientSession*> m_dirty;
+  // Sessions closed this round, freed after the poller returns
+  std::vector<int> m_closed;
+
+  TxOverflowStats m_txStats;
+  TxOverflowStats m_txReported;
+  std::chrono::steady_clock::time_point m_txReportedAt;
+};
+
+//
+// === ChatServer functions ===
+//
+
+template <typename Poller>
+ChatServer<Poller>::ChatServer(const std::vector<std::string>& ips, const std::string& port)
+  : m_port(port), m_ips(ips)
+{
+  m_sessions.Reserve(SESSION_PREWARM, SESSION_PREWARM);
+
+  // Created here, so RequestStop() is valid before Start()
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeFd < 0)
+  {
+    perror("eventfd");
+  }
+}
+
+template <typename Poller>
+ChatServer<Poller>::~ChatServer()
+{
+  Stop();
+  SafeCloseSocket(m_wakeFd);
+}
+
+/// <summary>
+/// Creates the poller and non-blocking listening sockets for all IPs, and enters
+/// the event loop. This function blocks until Stop() is invoked or an error occurs.
+/// </summary>
+template <typename Poller>
+void ChatServer<Poller>::Start()
+{
+  std::cout << "Strarting server...\n";
+
+  if (!m_poller.Init())
+  {
+    perror("poller init");
+    return;
+  }
+
+  if (m_wakeFd == -1 || !m_poller.Add(m_wakeFd, EpollTag::Pack(FdKind::Wakeup, m_wakeFd), false))
+  {
+    perror("wakeup eventfd");
+    return;
+  }
+
+  // Open non-blocking listening sockets for all configured IPs.
+  for (const auto& ip : m_ips)
+  {
+    int sfd = CreateListenSocket(ip);
+    if (sfd == -1)
+      continue;
+
+    if (!SetNonBlocking(sfd) || !m_poller.Add(sfd, EpollTag::Pack(FdKind::Listener, sfd), false))
+    {
+      perror("listen socket");
+      SafeCloseSocket(sfd);
+      continue;
+    }
+    m_listenSockets.push_back(sfd);
+  }
+
+  if (m_listenSockets.empty())
+  {
+    std::cerr << "Failed to create listening sockets\n";
+    return;
+  }
+
+  m_running = true;
+  RunLoop();
+
+  // Ensure cleanup when the loop exits.
+  Stop();
+}
+
+/// <summary>
+/// Stops the server, closes all sockets and client sessions.
+/// The method is idempotent and safe to call multiple times.
+/// </summary>
+template <typename Poller>
+void ChatServer<Poller>::Stop()
+{
+  if (!m_running && m_listenSockets.empty() && m_sessions.Empty())
+  {
+    return;
+  }
+
+  // Close clients
+  const auto& fds = m_sessions.LiveFds();
+  const auto& sessions = m_sessions.Live();
+  for (size_t i = 0; i < fds.size(); ++i)
+  {
+    m_poller.Remove(fds[i]);
+    sessions[i]->Stop();
+  }
+  m_sessions.Clear();
+  m_dirty.clear();
+  m_closed.clear();
+
+  // Close listeners
+  for (auto& s : m_listenSockets)
+  {
+    m_poller.Remove(s);
+    SafeCloseSocket(s);
+  }
+  m_listenSockets.clear();
+
+  if (m_wakeFd != -1)
+  {
+    m_poller.Remove(m_wakeFd);
+  }
+
+  m_running = false;
+}
+
+/// <summary>
+/// Asks the loop to stop and return from Start(). Only an atomic store and an
+/// eventfd write, so it may be called from other threads and signal handlers.
+/// </summary>
+template <typename Poller>
+void ChatServer<Poller>::RequestStop()
+{
+  m_running = false;
+  Wakeup();
+}
+
+template <typename Poller>
+void ChatServer<Poller>::Wakeup()
+{
+  if (m_wakeFd == -1)
+    return;
+
+  uint64_t one = 1;
+  if (write(m_wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+  {
+    perror("write eventfd");
+  }
+}
+
+/// <summary>
+/// Creates, binds and listens on a socket for the given IP address string.
+/// Returns -1 on failure.
+/// </summary>
+/// <param name="ip">IP address to bind (v4 or v6).</param>
+template <typename Poller>
+int ChatServer<Poller>::CreateListenSocket(const std::string& ip)
+{
+  int retVal = -1; // Socket fd
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+  hints.ai_flags = AI_PASSIVE;
+
+  addrinfo* result = nullptr;
+  if (getaddrinfo(ip.c_str(), m_port.c_str(), &hints, &result) != 0)
+  {
+    return -1;
+  }
+
+  for (addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next)
+  {
+    int sfd = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
+    if (sfd == -1) continue;
+
+    if (bind(sfd, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen)) == -1)
+    {
+      SafeCloseSocket(sfd);
+      continue;
+    }
+
+    if (listen(sfd, MAX_LISTEN) == -1)
+    {
+      SafeCloseSocket(sfd);
+      continue;
+    }
+
+    std::cout << "Server listening on: ";
+    PrintSockaddr(ptr->ai_addr);
+
+    retVal = sfd;
+    break;
+  }
+
+  freeaddrinfo(result);
+  return retVal;
+}
+
+/// <summary>
+/// One round: wait, dispatch, then fix up write interest and free closed sessions.
+/// </summary>
+template <typename Poller>
+void ChatServer<Poller>::RunLoop()
+{
+  while (m_running)
+  {
+    ReportTxStats();
+
+    int ready = m_poller.Wait(WaitTimeout(), [this](uint64_t data, uint32_t events) { HandleEvent(data, events); });
+
+    if (ready == -1)
+    {
+      if (errno == EINTR) continue; // Interrupted. Retry.
+      perror("poller wait");
+      break;
+    }
+
+    ApplyDirty();
+    FlushClosed();
+  }
+}
+
+/// <summary>
+/// Blocks until something happens, unless slow reader counters moved and are
+/// due to be logged; a wakeup just for the log would otherwise never come.
+/// </summary>
+template <typename Poller>
+int ChatServer<Poller>::WaitTimeout() const
+{
+  const TxOverflowStats& st = m_txStats;
+  if (st.droppedNewest == m_txReported.droppedNewest &&
+    st.droppedOldest == m_txReported.droppedOldest &&
+    st.disconnects == m_txReported.disconnects)
+  {
+    return -1;
+  }
+
+  auto due = m_txReportedAt + TX_REPORT_PERIOD - std::chrono::steady_clock::now();
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(due).count();
+  return ms > 0 ? static_cast<int>(ms) + 1 : 0;
+}
+
+//
+// === Handlers ===
+//
+
+template <typename Poller>
+void ChatServer<Poller>::HandleEvent(uint64_t data, uint32_t events)
+{
+  EpollTag tag = EpollTag::Unpack(data);
+  switch (tag.kind)
+  {
+  case FdKind::Client:
+  {
+    // Stale if the session was erased and the fd number reused since
+    ClientSession* sess = m_sessions.Get(tag.fd, tag.gen);
+    if (sess != nullptr)
+    {
+      HandleClient(sess, events);
+    }
+    break;
+  }
+  case FdKind::Listener:
+    HandleListener(tag.fd, events);
+    break;
+  case FdKind::Wakeup:
+    HandleWakeup();
+    break;
+  default:
+    break;
+  }
+}
+
+/// <summary>
+/// Resets the eventfd. The loop condition sees the stop request.
+/// </summary>
+template <typename Poller>
+void ChatServer<Poller>::HandleWakeup()
+{
+  uint64_t cnt = 0;
+  if (read(m_wakeFd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+  {
+    perror("read eventfd");
+  }
+}
+
+template <typename Poller>
+void ChatServer<Poller>::HandleListener(int sfd, uint32_t events)
+{
+  if (events & POLLER_ERROR)
+  {
+    std::cerr << "Listener fd = " << sfd << " error/hup/nval\n";
+    m_running = false;
+    return;
+  }
+
+  if (events & POLLER_READ)
+  {
+    AcceptAll(sfd);
+  }
+}
+
+template <typename Poller>
+void ChatServer<Poller>::HandleClient(ClientSession* sess, uint32_t events)
+{
+  if (sess->closing)
+    return;
+
+  // Errors / hangups first
+  if (events & POLLER_ERROR)
+  {
+    CloseClient(sess);
+    return;
+  }
+
+  // Readable
+  if (events & POLLER_READ)
+  {
+    if (!sess->Read([this, sess](const std::string& msg) { BroadcastMsg(msg, sess); }))
+    {
+      CloseClient(sess);
+      return;
+    }
+  }
+
+  // Writable
+  if (events & POLLER_WRITE)
+  {
+    if (!sess->Write())
+    {
+      CloseClient(sess);
+      return;
+    }
+    MarkDirty(sess);
+  }
+}
+
+//
+// === Handlers' helpers ===
+//
+
+template <typename Poller>
+void ChatServer<Poller>::AcceptAll(int sfd)
+{
+  while (true)
+  {
+    int cs = accept(sfd, nullptr, nullptr);
+
+    if (cs == -1)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        // No more clients
+        break;
+      }
+
+      std::perror("accept");
+      break;
+    }
+
+    if (!SetNonBlocking(cs))
+    {
+      std::perror("register client");
+      SafeCloseSocket(cs);
+      continue;
+    }
+
+    // Save in clients, the generation goes into the tag
+    if (m_sessions.Emplace(cs, cs, &m_txStats) == nullptr)
+    {
+      std::cerr << "Client fd = " << cs << " already has a session\n";
+      SafeCloseSocket(cs);
+      continue;
+    }
+
+    if (!m_poller.Add(cs, EpollTag::Pack(FdKind::Client, cs, m_sessions.GetGen(cs)), false))
+    {
+      std::perror("register client");
+      // Session destructor shuts down and closes the socket
+      m_sessions.Erase(cs);
+      continue;
+    }
+
+    // Optional greeting
+    static const char* hello = "Welcome to the chat!\n";
+    send(cs, hello, strlen(hello), MSG_NOSIGNAL);
+
+    // Log peer address
+    sockaddr_storage addr;
+    socklen_t addLen = sizeof(addr);
+    memset(&addr, 0, addLen);
+
+    if (getpeername(cs, reinterpret_cast<sockaddr*>(&addr), &addLen) == 0)
+    {
+      std::cout << "Client connected: ";
+      PrintSockaddr(reinterpret_cast<sockaddr*>(&addr));
+    }
+  }
+}
+
+/// <summary>
+/// Takes the session out of the poller and the broadcast. The socket stays open
+/// until FlushClosed(), so its fd number can't be handed out again this round.
+/// </summary>
+template <typename Poller>
+void ChatServer<Poller>::CloseClient(ClientSession* sess)
+{
+  if (sess->closing)
+    return;
+
+  sess->closing = true;
+  m_poller.Remove(sess->GetSocket());
+  m_closed.push_back(sess->GetSocket());
+}
+
+template <typename Poller>
+void ChatServer<Poller>::BroadcastMsg(const std::string& msg, ClientSession* pSender)
+{
+  for (ClientSession* s : m_sessions.Live())
+  {
+    if (s != pSender && !s->closing)
+    {
+      s->PostSend(msg);
+      MarkDirty(s);
+    }
+  }
+
+  std::cout << "Message broadcasted:" << msg << "\n";
+}
+
+template <typename Poller>
+void ChatServer<Poller>::MarkDirty(ClientSession* sess)
+{
+  if (sess->dirty)
+    return;
+
+  sess->dirty = true;
+  m_dirty.push_back(sess);
+}
+
+/// <summary>
+/// Registers or drops write interest for sessions whose send ring filled or drained
+/// this round. Sessions that stayed as they were cost the poller nothing.
+/// </summary>
+template <typename Poller>
+void ChatServer<Poller>::ApplyDirty()
+{
+  for (ClientSession* sess : m_dirty)
+  {
+    sess->dirty = false;
+    if (sess->closing)
+      continue;
+
+    bool want = sess->IsWantSend();
+    if (want == sess->writeArmed)
+      continue;
+
+    int fd = sess->GetSocket();
+    if (!m_poller.Update(fd, EpollTag::Pack(FdKind::Client, fd, m_sessions.GetGen(fd)), want))
+    {
+      perror("poller update");
+      CloseClient(sess);
+      continue;
+    }
+    sess->writeArmed = want;
+  }
+  m_dirty.clear();
+}
+
+template <typename Poller>
+void ChatServer<Poller>::FlushClosed()
+{
+  for (int sfd : m_closed)
+  {
+    // Session destructor shuts down and closes the socket, the generation moves on
+    m_sessions.Erase(sfd);
+  }
+  m_closed.clear();
+}
+
+/// <summary>
+/// Logs slow reader counters when they moved, at most once per TX_REPORT_PERIOD.
+/// </summary>
+template <typename Poller>
+void ChatServer<Poller>::ReportTxStats()
+{
+  const TxOverflowStats& st = m_txStats;
+  if (st.droppedNewest == m_txReported.droppedNewest &&
+    st.droppedOldest == m_txReported.droppedOldest &&
+    st.disconnects == m_txReported.disconnects)
+  {
+    return;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (now - m_txReportedAt < TX_REPORT_PERIOD)
+  {
+    return;
+  }
+
+  std::cout << "Send overflow: dropped newest: " << st.droppedNewest << " msgs"
+    << " oldest: " << st.droppedOldest << " msgs"
+    << " disconnects: " << st.disconnects << "\n";
+
+  m_txReported = st;
+  m_txReportedAt = now;
+}
@@ -0,0 +1,268 @@
+#include "ClientSession.h"
+
+#include <sys/socket.h> // send(), sendmsg(), shutdown()
+#include <sys/uio.h>    // iovec
+#include <unistd.h>     // close()
+
+constexpr bool INLINE_SEND = true; // try send() right away when nothing is queued
+constexpr size_t TX_HWM_BYTES = 4 * 1024 * 1024; // unsent bytes that trigger TX_OVERFLOW
+constexpr size_t TX_LWM_BYTES = 1024 * 1024;     // a shedding ring must drain to this to take messages again
+constexpr TxOverflowMode TX_OVERFLOW = TxOverflowMode::DisconnectOnOverflow;
+
+//
+// === ClientSession functions ===
+//
+
+ClientSession::ClientSession(int sfd, TxOverflowStats* txStats)
+  : m_socket(sfd), m_txStats(txStats) {}
+
+ClientSession::~ClientSession()
+{
+  Stop();
+}
+
+void ClientSession::Stop()
+{
+  if (m_socket != -1)
+  {
+    GracefulShutdown();
+    close(m_socket);
+    m_socket = -1;
+  }
+}
+
+void ClientSession::GracefulShutdown()
+{
+  shutdown(m_socket, SHUT_WR);
+
+  char buf[RECV_BUF];
+  while (true)
+  {
+    ssize_t bytes = recv(m_socket, buf, static_cast<size_t>(RECV_BUF), 0);
+
+    // peer closed connection
+    if (bytes == 0)
+      break;
+
+    // Error occured
+    if (bytes < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        break;
+      }
+
+      std::perror("recv");
+      break;
+    }
+  }
+}
+
+bool ClientSession::Write()
+{
+  while (!m_sendRing.Empty())
+  {
+    // Whole ring in one sendmsg(), two iovecs if it wraps
+    iovec iov[2];
+    size_t cnt = m_sendRing.Peek(iov);
+    size_t total = m_sendRing.Size();
+
+    msghdr mh{};
+    mh.msg_iov = iov;
+    mh.msg_iovlen = cnt;
+    ssize_t bytes = sendmsg(m_socket, &mh, MSG_NOSIGNAL);
+
+    // peer closed connection
+    if (bytes == 0) return false;
+
+    // Error occured
+    if (bytes < 0)
+    {
+      // Stream of recv fully read or try again later
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        return true;
+      }
+
+      std::perror("sendmsg");
+      return false;
+    }
+
+    ConsumeSent(static_cast<size_t>(bytes));
+
+    // Kernel buffer is full
+    if (static_cast<size_t>(bytes) < total)
+    {
+      return true; // Return for Server to call Write again later
+    }
+  }
+
+  // All was read and send queue is free to go
+  return true;
+}
+
+void ClientSession::PostSend(const std::string& msg)
+{
+  if (msg.empty() || m_overflowed)
+  {
+    return;
+  }
+
+  // Fast path: nothing queued and the kernel buffer usually has room,
+  // so skip waiting for write readiness on the next round
+  size_t offset = 0;
+  if (INLINE_SEND && m_sendRing.Empty())
+  {
+    ssize_t bytes = send(m_socket, msg.data(), msg.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (bytes == static_cast<ssize_t>(msg.size()))
+    {
+      return;
+    }
+
+    // Partial send queues the rest. On EAGAIN or error the whole msg is queued,
+    // errors surface on the next Write() or error event.
+    if (bytes > 0)
+    {
+      offset = static_cast<size_t>(bytes);
+    }
+  }
+
+  // Once the peer has the start of a message the rest must follow,
+  // refusing it would leave the stream cut mid-message
+  size_t bytes = msg.size() - offset;
+  if (offset == 0 && !AdmitSend(bytes))
+  {
+    return;
+  }
+
+  // A partly sent message is the front one, its start counts as sent
+  m_sendRing.Append(msg.data() + offset, bytes);
+  m_msgLens.push_back(static_cast<uint32_t>(msg.size()));
+  if (offset > 0)
+  {
+    m_frontSent = offset;
+  }
+}
+
+/// <summary>
+/// Moves the head past bytes just sent, retiring the messages they complete.
+/// </summary>
+void ClientSession::ConsumeSent(size_t bytes)
+{
+  m_sendRing.Consume(bytes);
+  if (m_sendRing.Empty())
+  {
+    DropRing();
+    return;
+  }
+
+  bytes += m_frontSent;
+  while (bytes >= m_msgLens[m_msgHead])
+  {
+    bytes -= m_msgLens[m_msgHead++];
+  }
+  m_frontSent = bytes;
+
+  // Retired lengths pile up while the ring never drains, compact now and then
+  if (m_msgHead >= 64 && m_msgHead * 2 >= m_msgLens.size())
+  {
+    m_msgLens.erase(m_msgLens.begin(), m_msgLens.begin() + m_msgHead);
+    m_msgHead = 0;
+  }
+}
+
+/// <summary>
+/// Evicts whole messages from the front until at most target bytes are unsent.
+/// A partially sent front message stays, the peer already has its start.
+/// </summary>
+void ClientSession::DropOldest(size_t target)
+{
+  size_t keep = 0;
+  size_t first = m_msgHead;
+  if (m_frontSent > 0)
+  {
+    keep = m_msgLens[first] - m_frontSent;
+    ++first;
+  }
+
+  size_t last = first;
+  size_t drop = 0;
+  while (last < m_msgLens.size() && m_sendRing.Size() - drop > target)
+  {
+    drop += m_msgLens[last++];
+  }
+
+  if (last == first)
+    return;
+
+  m_sendRing.Erase(keep, drop);
+  m_msgLens.erase(m_msgLens.begin() + first, m_msgLens.begin() + last);
+  m_txStats->droppedOldest += last - first;
+
+  if (m_sendRing.Empty())
+  {
+    DropRing();
+  }
+}
+
+/// <summary>
+/// Empties the ring and the message lengths, giving their storage back.
+/// </summary>
+void ClientSession::DropRing()
+{
+  m_sendRing.Consume(m_sendRing.Size());
+  std::vector<uint32_t>().swap(m_msgLens);
+  m_msgHead = 0;
+  m_frontSent = 0;
+}
+
+/// <summary>
+/// Applies the send ring bounds to a message of the given size about to be queued.
+/// Returns false if it must not be queued.
+/// </summary>
+bool ClientSession::AdmitSend(size_t bytes)
+{
+  TxOverflowStats& stats = *m_txStats;
+
+  // Hysteresis: once shedding, stay so until the reader has caught up
+  if (m_shedding)
+  {
+    if (m_sendRing.Size() > TX_LWM_BYTES)
+    {
+      ++stats.droppedNewest;
+      return false;
+    }
+    m_shedding = false;
+  }
+
+  // An empty ring takes any one message, or one bigger than the HWM would never go out
+  if (m_sendRing.Size() == 0 || m_sendRing.Size() + bytes <= TX_HWM_BYTES)
+    return true;
+
+  switch (TX_OVERFLOW)
+  {
+    case TxOverflowMode::DropNewest:
+      m_shedding = true;
+      ++stats.droppedNewest;
+      return false;
+
+    case TxOverflowMode::DropOldest:
+      DropOldest(TX_LWM_BYTES > bytes ? TX_LWM_BYTES - bytes : 0);
+      if (m_sendRing.Size() + bytes <= TX_HWM_BYTES)
+        return true;
+
+      // Whatever is left is already being sent
+      ++stats.droppedNewest;
+      return false;
+
+    case TxOverflowMode::DisconnectOnOverflow:
+    default:
+      // Closing here would erase the session under the broadcast loop.
+      // The hangup this raises closes it on the next round.
+      m_overflowed = true;
+      DropRing();
+      shutdown(m_socket, SHUT_RDWR);
+      ++stats.disconnects;
+      return false;
+  }
+}
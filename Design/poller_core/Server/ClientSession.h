@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cerrno>
+
+#include <sys/socket.h> // recv()
+
+#include "ByteRing.h"
+
+/// <summary>
+/// What a session does with a message once its send ring is over the high watermark.
+/// </summary>
+enum class TxOverflowMode
+{
+  DropNewest,          // refuse new messages until the ring drains to the low watermark
+  DropOldest,          // discard whole unsent messages from the head down to the low watermark
+  DisconnectOnOverflow // slow reader is cut off
+};
+
+/// <summary>
+/// Slow reader counters, bumped by sessions whose send ring hits the high watermark.
+/// </summary>
+struct TxOverflowStats
+{
+  uint64_t droppedNewest = 0; // messages refused
+  uint64_t droppedOldest = 0; // unsent messages discarded from ring heads
+  uint64_t disconnects = 0;   // sessions cut off
+};
+
+/// <summary>
+/// Client session with non-blocking recv/send and a send ring. Knows nothing of
+/// the server or the poller, received messages go to the callback Read() is given.
+/// </summary>
+class ClientSession
+{
+public:
+  static constexpr int RECV_BUF = 4096;
+
+  ClientSession(int socket, TxOverflowStats* txStats);
+  ~ClientSession();
+
+  void Stop();
+
+  int GetSocket() const { return m_socket; }
+  bool IsWantSend() const { return !m_sendRing.Empty(); }
+
+  /// <summary>
+  /// Reads to EAGAIN, handing every chunk to onMsg. Returns false if the session must close.
+  /// </summary>
+  template <typename OnMsg>
+  bool Read(OnMsg&& onMsg)
+  {
+    char buf[RECV_BUF];
+    while (true)
+    {
+      ssize_t bytes = recv(m_socket, buf, static_cast<size_t>(RECV_BUF), 0);
+
+      // peer closed connection
+      if (bytes == 0) return false;
+
+      // Error occured
+      if (bytes < 0)
+      {
+        // Stream of recv fully read
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+          return true;
+        }
+
+        std::perror("recv");
+        return false;
+      }
+
+      std::string msg(buf, buf + bytes);
+      onMsg(msg);
+    }
+  }
+
+  bool Write();
+  void PostSend(const std::string& msg);
+
+public:
+  // Core bookkeeping, owned by ChatServer<Poller>
+  bool writeArmed = false; // write interest currently registered with the poller
+  bool dirty = false;      // queued for an interest check after this round
+  bool closing = false;    // closed this round, freed once the poller returns
+
+private:
+  void GracefulShutdown();
+  bool AdmitSend(size_t bytes);
+  void ConsumeSent(size_t bytes);
+  void DropOldest(size_t target);
+  void DropRing();
+
+private:
+  int m_socket;
+  TxOverflowStats* m_txStats;
+
+  // Bytes waiting for write readiness, flushed with at most two iovecs
+  ByteRing m_sendRing;
+  // Length of every message in the ring from m_msgHead on, so drops keep to message
+  // boundaries. Like the ring, emptied and given back once everything is sent.
+  std::vector<uint32_t> m_msgLens;
+  size_t m_msgHead = 0;
+  size_t m_frontSent = 0;    // bytes of the front message already sent
+  bool m_shedding = false;   // DropNewest: over the high watermark until drained to the low one
+  bool m_overflowed = false; // cut off, waiting for the poller to report the hangup
+};
@@ -0,0 +1,55 @@
+#include "EpollPoller.h"
+#include "SocketUtils.h"
+
+constexpr int MAX_EVENTS = 1024; // events per epoll_wait()
+
+//
+// === EpollPoller functions ===
+//
+
+EpollPoller::~EpollPoller()
+{
+  SafeCloseSocket(m_epoll);
+}
+
+bool EpollPoller::Init()
+{
+  m_epoll = epoll_create1(EPOLL_CLOEXEC);
+  if (m_epoll < 0)
+    return false;
+
+  m_events.resize(MAX_EVENTS);
+  return true;
+}
+
+bool EpollPoller::Add(int fd, uint64_t tag, bool wantWrite)
+{
+  return Ctl(EPOLL_CTL_ADD, fd, tag, wantWrite);
+}
+
+bool EpollPoller::Update(int fd, uint64_t tag, bool wantWrite)
+{
+  return Ctl(EPOLL_CTL_MOD, fd, tag, wantWrite);
+}
+
+void EpollPoller::Remove(int fd)
+{
+  epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+bool EpollPoller::Ctl(int op, int fd, uint64_t tag, bool wantWrite)
+{
+  epoll_event ev{};
+  ev.events = EPOLLIN | EPOLLRDHUP | (wantWrite ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+  ev.data.u64 = tag;
+  return epoll_ctl(m_epoll, op, fd, &ev) == 0;
+}
+
+uint32_t EpollPoller::Translate(uint32_t events)
+{
+  uint32_t ev = 0;
+  if (events & EPOLLIN)  ev |= POLLER_READ;
+  if (events & EPOLLOUT) ev |= POLLER_WRITE;
+  if (events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) ev |= POLLER_ERROR;
+  return ev;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <sys/epoll.h>  // epoll()
+
+#include "Poller.h"
+
+/// <summary>
+/// epoll backend, level-triggered. The kernel keeps the interest set, so an fd costs
+/// an epoll_ctl() on add/remove and when write interest flips, and nothing per round.
+/// The tag rides in epoll_event.data.u64.
+/// </summary>
+class EpollPoller
+{
+public:
+  EpollPoller() = default;
+  ~EpollPoller();
+
+  EpollPoller(const EpollPoller&) = delete;
+  EpollPoller& operator=(const EpollPoller&) = delete;
+
+  bool Init();
+  bool Add(int fd, uint64_t tag, bool wantWrite);
+  bool Update(int fd, uint64_t tag, bool wantWrite);
+  void Remove(int fd);
+
+  template <typename F>
+  int Wait(int timeoutMs, F&& onEvent)
+  {
+    int ready = epoll_wait(m_epoll, m_events.data(), static_cast<int>(m_events.size()), timeoutMs);
+
+    // Removing an fd doesn't touch the returned array, dispatch in place
+    for (int i = 0; i < ready; ++i)
+    {
+      onEvent(m_events[i].data.u64, Translate(m_events[i].events));
+    }
+    return ready;
+  }
+
+private:
+  bool Ctl(int op, int fd, uint64_t tag, bool wantWrite);
+  static uint32_t Translate(uint32_t events);
+
+private:
+  int m_epoll = -1;
+  std::vector<epoll_event> m_events;
+};
@@ -0,0 +1,82 @@
+#include "PollPoller.h"
+
+//
+// === PollPoller functions ===
+//
+
+bool PollPoller::Init()
+{
+  m_pollfds.reserve(128);
+  m_tags.reserve(128);
+  return true;
+}
+
+bool PollPoller::Add(int fd, uint64_t tag, bool wantWrite)
+{
+  if (fd < 0 || FindSlot(fd) != nullptr)
+    return false;
+
+  pollfd pfd{};
+  pfd.fd = fd;
+  pfd.events = static_cast<short>(POLLIN | (wantWrite ? POLLOUT : 0));
+
+  if (static_cast<size_t>(fd) >= m_slots.size())
+  {
+    m_slots.resize(static_cast<size_t>(fd) + 1, NO_SLOT);
+  }
+  m_slots[fd] = m_pollfds.size();
+  m_pollfds.push_back(pfd);
+  m_tags.push_back(tag);
+  return true;
+}
+
+bool PollPoller::Update(int fd, uint64_t tag, bool wantWrite)
+{
+  size_t* slot = FindSlot(fd);
+  if (slot == nullptr)
+    return false;
+
+  m_pollfds[*slot].events = static_cast<short>(POLLIN | (wantWrite ? POLLOUT : 0));
+  m_tags[*slot] = tag;
+  return true;
+}
+
+/// <summary>
+/// Moves the last entry into the freed slot, so the array stays dense.
+/// </summary>
+void PollPoller::Remove(int fd)
+{
+  size_t* pSlot = FindSlot(fd);
+  if (pSlot == nullptr)
+    return;
+
+  size_t slot = *pSlot;
+  *pSlot = NO_SLOT;
+
+  size_t last = m_pollfds.size() - 1;
+  if (slot != last)
+  {
+    m_pollfds[slot] = m_pollfds[last];
+    m_tags[slot] = m_tags[last];
+    m_slots[m_pollfds[slot].fd] = slot;
+  }
+  m_pollfds.pop_back();
+  m_tags.pop_back();
+}
+
+size_t* PollPoller::FindSlot(int fd)
+{
+  if (fd < 0 || static_cast<size_t>(fd) >= m_slots.size() || m_slots[fd] == NO_SLOT)
+    return nullptr;
+
+  return &m_slots[fd];
+}
+
+uint32_t PollPoller::Translate(short revents)
+{
+  uint32_t ev = 0;
+  if (revents & POLLIN)  ev |= POLLER_READ;
+  if (revents & POLLOUT) ev |= POLLER_WRITE;
+  if (revents & (POLLERR | POLLHUP | POLLNVAL)) ev |= POLLER_ERROR;
+  return ev;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include <sys/poll.h>   // poll()
+
+#include "Poller.h"
+
+/// <summary>
+/// poll() backend. The pollfd array persists across rounds: fds are appended on Add,
+/// swap-removed on Remove and their events edited in place, found through an fd-indexed
+/// slot table. Tags sit in a parallel array, so pollfd stays what poll() expects.
+/// </summary>
+class PollPoller
+{
+public:
+  static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+  bool Init();
+  bool Add(int fd, uint64_t tag, bool wantWrite);
+  bool Update(int fd, uint64_t tag, bool wantWrite);
+  void Remove(int fd);
+
+  template <typename F>
+  int Wait(int timeoutMs, F&& onEvent)
+  {
+    int ready = poll(m_pollfds.data(), m_pollfds.size(), timeoutMs);
+    if (ready <= 0)
+      return ready;
+
+    // Handlers may swap-remove entries, collect first
+    m_ready.clear();
+    for (size_t i = 0; i < m_pollfds.size(); ++i)
+    {
+      if (m_pollfds[i].revents == 0)
+        continue;
+
+      m_ready.push_back({ m_tags[i], Translate(m_pollfds[i].revents) });
+      if (m_ready.size() == static_cast<size_t>(ready))
+        break;
+    }
+
+    for (const auto& r : m_ready)
+    {
+      onEvent(r.tag, r.events);
+    }
+    return ready;
+  }
+
+private:
+  static uint32_t Translate(short revents);
+  size_t* FindSlot(int fd);
+
+private:
+  std::vector<pollfd> m_pollfds;
+  std::vector<uint64_t> m_tags;   // parallel to m_pollfds
+  std::vector<size_t> m_slots;    // fd -> slot in m_pollfds, NO_SLOT if absent
+  std::vector<PollerReady> m_ready;
+};
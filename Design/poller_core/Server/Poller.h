@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// Readiness bits a poller reports for an fd, translated from its native flags.
+/// </summary>
+enum PollerEvent : uint32_t
+{
+  POLLER_READ = 1,
+  POLLER_WRITE = 2,
+  POLLER_ERROR = 4  // error or hangup, the core closes the fd
+};
+
+/// <summary>
+/// One ready fd's tag, collected before dispatch by pollers whose fd set the
+/// handlers could otherwise reshuffle mid-iteration.
+/// </summary>
+struct PollerReady
+{
+  uint64_t tag;
+  uint32_t events;
+};
+
+//
+// Poller policy, what ChatServer<Poller> calls. Resolved at compile time,
+// there is no base class:
+//
+//   bool Init();                                   // false on failure, errno set
+//   bool Add(int fd, uint64_t tag, bool wantWrite); // read interest always on
+//   bool Update(int fd, uint64_t tag, bool wantWrite); // only called when wantWrite changes
+//   void Remove(int fd);                           // before the fd is closed
+//   template <typename F>
+//   int Wait(int timeoutMs, F&& onEvent);          // calls onEvent(tag, PollerEvent bits),
+//                                                  // returns the ready count or -1
+//
+// The tag is an EpollTag the core packs per fd. Pollers hand it back untouched,
+// so the core dispatches on its kind and reaches a session by slab index, with no
+// lookup by fd. Handlers run inside Wait() and may Add/Remove fds, but the core
+// closes fds only after Wait() returns, so no fd number is reused within a round.
+//
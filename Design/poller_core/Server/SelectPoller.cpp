@@ -0,0 +1,82 @@
+#include "SelectPoller.h"
+
+#include <cerrno>
+
+//
+// === SelectPoller functions ===
+//
+
+bool SelectPoller::Init()
+{
+  m_fds.reserve(128);
+  return true;
+}
+
+bool SelectPoller::Add(int fd, uint64_t tag, bool wantWrite)
+{
+  // FD_SET past the end of the set is undefined behaviour
+  if (fd < 0 || fd >= FD_SETSIZE)
+  {
+    errno = EMFILE;
+    return false;
+  }
+
+  if (m_slots[fd] != NO_SLOT)
+    return false;
+
+  m_slots[fd] = m_fds.size();
+  m_fds.push_back(fd);
+  m_tags[fd] = tag;
+  m_wantWrite[fd] = wantWrite;
+  return true;
+}
+
+bool SelectPoller::Update(int fd, uint64_t tag, bool wantWrite)
+{
+  if (fd < 0 || fd >= FD_SETSIZE || m_slots[fd] == NO_SLOT)
+    return false;
+
+  m_tags[fd] = tag;
+  m_wantWrite[fd] = wantWrite;
+  return true;
+}
+
+void SelectPoller::Remove(int fd)
+{
+  if (fd < 0 || fd >= FD_SETSIZE || m_slots[fd] == NO_SLOT)
+    return;
+
+  size_t slot = m_slots[fd];
+  m_slots[fd] = NO_SLOT;
+  m_wantWrite[fd] = false;
+
+  size_t last = m_fds.size() - 1;
+  if (slot != last)
+  {
+    m_fds[slot] = m_fds[last];
+    m_slots[m_fds[slot]] = slot;
+  }
+  m_fds.pop_back();
+}
+
+/// <summary>
+/// Fills both sets from the registered fds. Returns the highest fd.
+/// </summary>
+int SelectPoller::BuildSets(fd_set& readSet, fd_set& writeSet) const
+{
+  FD_ZERO(&readSet);
+  FD_ZERO(&writeSet);
+
+  int maxFd = -1;
+  for (int fd : m_fds)
+  {
+    FD_SET(fd, &readSet);
+    if (m_wantWrite[fd])
+    {
+      FD_SET(fd, &writeSet);
+    }
+
+    if (fd > maxFd) maxFd = fd;
+  }
+  return maxFd;
+}
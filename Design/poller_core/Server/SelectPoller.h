@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <bitset>
+#include <cstddef>
+
+#include <sys/select.h> // select(), FD_SETSIZE
+
+#include "Poller.h"
+
+/// <summary>
+/// POSIX select() backend, the Windows select server's model on Linux. fd_sets are
+/// rebuilt from the registered fds every round and fds at or above FD_SETSIZE are
+/// refused, so it is the baseline to compare the others against, not one to deploy.
+/// </summary>
+class SelectPoller
+{
+public:
+  static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+  bool Init();
+  bool Add(int fd, uint64_t tag, bool wantWrite);
+  bool Update(int fd, uint64_t tag, bool wantWrite);
+  void Remove(int fd);
+
+  template <typename F>
+  int Wait(int timeoutMs, F&& onEvent)
+  {
+    fd_set readSet;
+    fd_set writeSet;
+    int maxFd = BuildSets(readSet, writeSet);
+
+    timeval tv{};
+    timeval* ptv = nullptr;
+    if (timeoutMs >= 0)
+    {
+      tv.tv_sec = timeoutMs / 1000;
+      tv.tv_usec = (timeoutMs % 1000) * 1000;
+      ptv = &tv;
+    }
+
+    int ready = select(maxFd + 1, &readSet, &writeSet, nullptr, ptv);
+    if (ready <= 0)
+      return ready;
+
+    // Handlers may swap-remove entries, collect first
+    m_ready.clear();
+    for (int fd : m_fds)
+    {
+      uint32_t ev = 0;
+      if (FD_ISSET(fd, &readSet))  ev |= POLLER_READ;
+      if (FD_ISSET(fd, &writeSet)) ev |= POLLER_WRITE;
+      if (ev)
+      {
+        m_ready.push_back({ m_tags[fd], ev });
+      }
+    }
+
+    for (const auto& r : m_ready)
+    {
+      onEvent(r.tag, r.events);
+    }
+    return ready;
+  }
+
+private:
+  int BuildSets(fd_set& readSet, fd_set& writeSet) const;
+
+private:
+  std::vector<int> m_fds;
+  // fd -> slot in m_fds and fd -> tag, sized by FD_SETSIZE since no larger fd is accepted
+  std::vector<size_t> m_slots = std::vector<size_t>(FD_SETSIZE, NO_SLOT);
+  std::vector<uint64_t> m_tags = std::vector<uint64_t>(FD_SETSIZE, 0);
+  std::bitset<FD_SETSIZE> m_wantWrite;
+  std::vector<PollerReady> m_ready;
+};
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <csignal>
+
+#include "ChatServer.h"
+
+// Backend is fixed per build target, see CMakeLists.txt
+#if defined(CHAT_POLLER_EPOLL)
+#include "EpollPoller.h"
+using Poller = EpollPoller;
+#elif defined(CHAT_POLLER_SELECT)
+#include "SelectPoller.h"
+using Poller = SelectPoller;
+#else
+#include "PollPoller.h"
+using Poller = PollPoller;
+#endif
+
+static ChatServer<Poller>* g_server = nullptr;
+
+/// <summary>
+/// Ctrl+C / SIGTERM: wakes the loop through its eventfd, it shuts down cleanly.
+/// </summary>
+static void OnStopSignal(int)
+{
+  if (g_server)
+    g_server->RequestStop();
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> ipadds;
+  std::string port = "27015";
+
+  if (argc > 1) 
+  {
+    port = argv[1];
+
+    for (int i = 2; i < argc; ++i)
+      ipadds.emplace_back(argv[i]);
+  }
+
+  // If no ip provided, than standard
+  if (ipadds.empty()) 
+  {
+    // Lookback localhost
+    ipadds = 
+    {
+        "127.0.0.1",
+        "::1"
+    };
+  }
+
+  try
+  {
+    auto pServer = std::make_unique<ChatServer<Poller>>(ipadds, port);
+
+    g_server = pServer.get();
+    std::signal(SIGINT, OnStopSignal);
+    std::signal(SIGTERM, OnStopSignal);
+
+    pServer->Start();
+    g_server = nullptr;
+  }
+  catch (const std::exception& ex)
+  {
+    std::cout << "Exception occured with server!\n" << ex.what() << "\n";
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <sys/socket.h> // sockaddr
+
+/// <summary>
+/// Safely closes a socket and sets it to -1.
+/// </summary>
+void SafeCloseSocket(int& socketfd);
+
+/// <summary>
+/// Sets file descriptor to non-blocking mode.
+/// </summary>
+bool SetNonBlocking(int& sfd);
+
+/// <summary>
+/// prints a sockaddr (IPv4/IPv6) as "ip:port".
+/// </summary>
+void PrintSockaddr(const sockaddr* addr);
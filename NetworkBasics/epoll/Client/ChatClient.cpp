@@ -10,6 +10,7 @@
 #include <arpa/inet.h>  // inet_ntop()
 #include <netdb.h>      // getaddrinfo(), freeaddrinfo()
 #include <fcntl.h>      // fcntl()
+#include <sys/eventfd.h> // eventfd()
 
 using std::cout;
 using std::cerr;
@@ -54,11 +55,21 @@ static bool SetNonBlocking(int& sfd)
 //
 
 ChatClient::ChatClient(const char* ipadd, const char* port)
-  : m_ip(ipadd), m_port(port) {}
+  : m_ip(ipadd), m_port(port)
+{
+  // Created here, so Send() and Stop() from the input thread can always signal it
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeFd < 0)
+  {
+    perror("eventfd");
+  }
+}
 
 ChatClient::~ChatClient()
 {
   Stop();
+  Close();
+  SafeCloseSocket(m_wakeFd);
 }
 
 void ChatClient::Start()
@@ -67,14 +78,21 @@ void ChatClient::Start()
   {
     cerr << "Failed to establish connection to "
         << m_ip << ":" << m_port << "\n";
-    Stop();
+    Close();
     return;
   }
 
   if (!SetNonBlocking(m_socket))
   {
     cerr << "Failed to make socket non blocking";
-    Stop();
+    Close();
+    return;
+  }
+
+  if (m_wakeFd == -1)
+  {
+    cerr << "No wakeup eventfd\n";
+    Close();
     return;
   }
 
@@ -82,28 +100,36 @@ void ChatClient::Start()
 
   CreateEpoll();
   AddSockToEpoll(); 
+  AddWakeToEpoll();
 
   RunLoop();
-  Stop();
+  Close();
 }
 
+/// <summary>
+/// Asks the loop to exit. It blocks in epoll_wait() with no timeout, so it is woken.
+/// </summary>
 void ChatClient::Stop()
 {
-  cout << "Closing the connection\n";
-  cout << "Type /quit to quit";
   m_running.store(false, std::memory_order::memory_order_release);
+  Wakeup();
+}
 
-  if (m_socket == -1)
+/// <summary>
+/// Closes the connection and the epoll set. Called by the loop thread once RunLoop() returned.
+/// </summary>
+void ChatClient::Close()
+{
+  m_running.store(false, std::memory_order::memory_order_release);
+
+  if (m_socket != -1)
   {
-    if (m_epoll != -1) 
-    { 
-      close(m_epoll); m_epoll = -1; 
-    }
-    return;
-  }
+    cout << "Closing the connection\n";
+    cout << "Type /quit to quit";
 
-  shutdown(m_socket, SHUT_WR);
-  SafeCloseSocket(m_socket);
+    shutdown(m_socket, SHUT_WR);
+    SafeCloseSocket(m_socket);
+  }
 
   if (m_epoll != -1)
   {
@@ -112,6 +138,18 @@ void ChatClient::Stop()
   }
 }
 
+void ChatClient::Wakeup()
+{
+  if (m_wakeFd == -1)
+    return;
+
+  uint64_t one = 1;
+  if (write(m_wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+  {
+    perror("write eventfd");
+  }
+}
+
 bool ChatClient::CreateConnection()
 {
   addrinfo hints, *result;
@@ -173,7 +211,10 @@ void ChatClient::RunLoop()
     for (int i = 0; i < n; ++i)
     {
       uint32_t ev = events[i].events;
-      if (!HandleConnection(ev))
+      bool ok = (events[i].data.fd == m_wakeFd)
+        ? HandleWakeup()
+        : HandleConnection(ev);
+      if (!ok)
       {
         m_running.store(false, std::memory_order::memory_order_release);
         break;
@@ -195,6 +236,44 @@ void ChatClient::AddSockToEpoll()
   }
 }
 
+/// <summary>
+/// Level-triggered, so the counter must be read back to zero.
+/// </summary>
+void ChatClient::AddWakeToEpoll()
+{
+  epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.data.fd = m_wakeFd;
+  ev.events = EPOLLIN;
+
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeFd, &ev) < 0)
+  {
+    perror("epoll_ctl ADD eventfd");
+  }
+}
+
+/// <summary>
+/// Resets the eventfd and sends what Send() queued right away; EPOLLOUT is only
+/// armed if the socket took less. Returns false if a stop was requested.
+/// </summary>
+bool ChatClient::HandleWakeup()
+{
+  uint64_t cnt = 0;
+  if (read(m_wakeFd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+  {
+    perror("read eventfd");
+  }
+
+  if (!m_running.load(std::memory_order::memory_order_acquire))
+    return false;
+
+  if (!Write())
+    return false;
+
+  UpdateWritable();
+  return true;
+}
+
 bool ChatClient::HandleConnection(uint32_t& ev)
 {
   if (ev & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
@@ -218,9 +297,7 @@ bool ChatClient::HandleConnection(uint32_t& ev)
     }
 
     // If queue is empty no need to epollout still be raised
-    std::lock_guard<std::mutex> lg(m_sendMutex);
-    if (m_sendQueue.empty())
-      ModWritable(false);
+    UpdateWritable();
   }
 
   return true;
@@ -284,9 +361,7 @@ bool ChatClient::Write()
     if (bytes < static_cast<ssize_t>(msg.size()))
     {
       msg.erase(0, static_cast<size_t>(bytes));
-     // Still something to send? 
-      ModWritable(true);
-      return true;
+      return true; // Caller arms EPOLLOUT for the rest
     }
 
     m_sendQueue.pop_front();
@@ -301,13 +376,36 @@ void ChatClient::Send(const std::string& msg)
   if (msg.empty())
     return;
 
+  bool wasEmpty = false;
   {
     std::lock_guard<std::mutex> lg(m_sendMutex);
+    wasEmpty = m_sendQueue.empty();
     m_sendQueue.push_back(msg);
   }
 
-  // Trigger sending event
-  ModWritable(true);
+  // Loop thread sends it. A non-empty queue has already signalled or has EPOLLOUT armed.
+  if (wasEmpty)
+  {
+    Wakeup();
+  }
+}
+
+/// <summary>
+/// Arms EPOLLOUT while something is left to send and drops it once drained.
+/// Loop thread only, epoll_ctl() is issued only when that changes.
+/// </summary>
+void ChatClient::UpdateWritable()
+{
+  bool want = false;
+  {
+    std::lock_guard<std::mutex> lg(m_sendMutex);
+    want = !m_sendQueue.empty();
+  }
+
+  if (want != m_writeArmed)
+  {
+    ModWritable(want);
+  }
 }
 
 void ChatClient::ModWritable(const bool& enable)
@@ -318,12 +416,9 @@ void ChatClient::ModWritable(const bool& enable)
   }
 
   uint32_t event = EPOLLIN | EPOLLRDHUP | EPOLLET;
+  if (enable)
   {
-    std::lock_guard<std::mutex> lg(m_sendMutex);
-    if (enable && !m_sendQueue.empty())
-    {
-      event |= EPOLLOUT;
-    }
+    event |= EPOLLOUT;
   }
 
   epoll_event ev{};
@@ -332,5 +427,7 @@ void ChatClient::ModWritable(const bool& enable)
   if (epoll_ctl(m_epoll, EPOLL_CTL_MOD, m_socket, &ev) < 0)
   {
     perror("epoll_ctl MOD client-sock");
+    return;
   }
+  m_writeArmed = enable;
 }
\ No newline at end of file
@@ -16,6 +16,7 @@ public:
 
 
   void Start();
+  // Safe from any thread, the loop closes the connection on its way out
   void Stop();
 
   void Send(const std::string& msg);
@@ -23,11 +24,16 @@ public:
 private:
   bool CreateConnection();
   void RunLoop();
+  void Close();
 
   void CreateEpoll();
   void AddSockToEpoll();
+  void AddWakeToEpoll();
+  bool HandleWakeup();
   bool HandleConnection(uint32_t& ev);
 
+  void Wakeup();
+  void UpdateWritable();
   void ModWritable(const bool& enable);
   bool Read();
   bool Write();
@@ -39,6 +45,9 @@ private:
   std::atomic<bool> m_running {false};
   int m_socket = -1;
   int m_epoll = -1;
+  // Signalled by Send() and Stop(), in the epoll set next to the socket
+  int m_wakeFd = -1;
+  bool m_writeArmed = false; // EPOLLOUT registered, loop thread only
 
   std::mutex m_sendMutex;
   std::deque<std::string> m_sendQueue;
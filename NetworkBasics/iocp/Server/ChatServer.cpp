@@ -385,7 +385,7 @@ void ChatServer::OnRecvComplete(ClientSession* sess, DWORD bytes, bool ok)
   }
 
   // Broadcast to others (skip sender)
-  std::string msg(sess->m_recvBuf, sess->m_recvBuf + bytes);
+  std::string msg(sess->m_recvBuf.get(), sess->m_recvBuf.get() + bytes);
   BroadcastMsg(msg, sess);
 
   // Keep receiving
@@ -6,15 +6,15 @@
 
 
 ClientSession::ClientSession(SOCKET socket, ChatServer* server)
-  : m_socket(socket), m_server(server)
+  : m_recvBuf(new char[RECV_BUF]), m_socket(socket), m_server(server)
 {
   std::memset(&m_ovRecv, 0, sizeof(m_ovRecv));
   std::memset(&m_ovSend, 0, sizeof(m_ovSend));
   m_ovRecv.kind = OvEx::Kind::Recv;
   m_ovSend.kind = OvEx::Kind::Send;
 
-  m_recvBufWsa.buf = m_recvBuf;
-  m_recvBufWsa.len = sizeof(m_recvBuf);
+  m_recvBufWsa.buf = m_recvBuf.get();
+  m_recvBufWsa.len = static_cast<ULONG>(RECV_BUF);
 }
 
 ClientSession::~ClientSession()
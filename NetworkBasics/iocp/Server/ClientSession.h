@@ -2,6 +2,7 @@
 
 #include <string>
 #include <deque>
+#include <memory>
 #include <winsock2.h>
 
 #include "Shared.h"
@@ -23,11 +24,13 @@ public:
 
   SOCKET GetSocket() const { return m_socket; }
 
+  static constexpr size_t RECV_BUF = 64 * 1024;
+
   // Exposed to server's completion loop:
   OvEx   m_ovRecv;
   OvEx   m_ovSend;
   WSABUF m_recvBufWsa{};
-  char   m_recvBuf[64 * 1024]{};
+  std::unique_ptr<char[]> m_recvBuf; // out of line, keeps the session itself small
 
   std::deque<std::string> m_sendQueue;
   bool m_sendInFlight = false;
@@ -10,12 +10,14 @@
 #include <arpa/inet.h>  // inet_ntop()
 #include <netdb.h>      // getaddrinfo(), freeaddrinfo()
 #include <fcntl.h>      // fcntl()
+#include <sys/eventfd.h> // eventfd()
 
 using std::cout;
 using std::cerr;
 
 constexpr int RECV_BUF = 4096;
-constexpr int TIMEOUT_MS = 1000; // 1s timeout fo poll
+constexpr size_t SOCK_SLOT = 0;
+constexpr size_t WAKE_SLOT = 1;
 
 //
 // === UTILS ===
@@ -56,13 +58,21 @@ static bool SetNonBlocking(int& sfd)
 ChatClient::ChatClient(const char* ipadd, const char* port)
   : m_ip(ipadd), m_port(port) 
 {
-  // may be this
-  // memset(&m_poll, 0, sizeof(m_poll));
+  memset(&m_poll, 0, sizeof(m_poll));
+
+  // Created here, so Send() and Stop() from the input thread can always signal it
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeFd < 0)
+  {
+    perror("eventfd");
+  }
 }
 
 ChatClient::~ChatClient()
 {
   Stop();
+  Close();
+  SafeCloseSocket(m_wakeFd);
 }
 
 void ChatClient::Start()
@@ -71,36 +81,68 @@ void ChatClient::Start()
   {
     cerr << "Failed to establish connection to "
         << m_ip << ":" << m_port << "\n";
-    Stop();
+    Close();
     return;
   }
 
   if (!SetNonBlocking(m_socket))
   {
     cerr << "Failed to make socket non blocking";
-    Stop();
+    Close();
+    return;
+  }
+
+  if (m_wakeFd == -1)
+  {
+    cerr << "No wakeup eventfd\n";
+    Close();
     return;
   }
 
   m_running.store(true, std::memory_order::memory_order_release);
 
   RunLoop();
-  Stop();
+  Close();
 }
 
+/// <summary>
+/// Asks the loop to exit. It may be blocked in poll() with no timeout, so it is woken.
+/// </summary>
 void ChatClient::Stop()
 {
-  cout << "Closing the connection\n";
-  cout << "Type /quit to quit";
+  m_running.store(false, std::memory_order::memory_order_release);
+  Wakeup();
+}
+
+/// <summary>
+/// Closes the connection. Called by the loop thread once RunLoop() returned.
+/// </summary>
+void ChatClient::Close()
+{
   m_running.store(false, std::memory_order::memory_order_release);
 
   if (m_socket == -1)
     return;
 
+  cout << "Closing the connection\n";
+  cout << "Type /quit to quit";
+
   shutdown(m_socket, SHUT_WR);
   SafeCloseSocket(m_socket);
 }
 
+void ChatClient::Wakeup()
+{
+  if (m_wakeFd == -1)
+    return;
+
+  uint64_t one = 1;
+  if (write(m_wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+  {
+    perror("write eventfd");
+  }
+}
+
 bool ChatClient::CreateConnection()
 {
   addrinfo hints, *result;
@@ -144,7 +186,7 @@ void ChatClient::RunLoop()
   {
     SetPollEvents();
 
-    int ready = poll(&m_poll, 1, TIMEOUT_MS);
+    int ready = poll(m_poll, 2, -1);
 
     if (ready == -1) 
     {
@@ -158,14 +200,19 @@ void ChatClient::RunLoop()
 
     if (!HandleConnection())
       break;
+
+    if (!HandleWakeup())
+      break;
   }
 }
 
 void ChatClient::CreatePoll()
 {
   memset(&m_poll, 0, sizeof(m_poll));
-  m_poll.fd = m_socket;
-  m_poll.events = POLLIN;
+  m_poll[SOCK_SLOT].fd = m_socket;
+  m_poll[SOCK_SLOT].events = POLLIN;
+  m_poll[WAKE_SLOT].fd = m_wakeFd;
+  m_poll[WAKE_SLOT].events = POLLIN;
 }
 
 void ChatClient::SetPollEvents()
@@ -177,18 +224,40 @@ void ChatClient::SetPollEvents()
   }
 
   isEmpty 
-    ? m_poll.events &= ~POLLOUT
-    : m_poll.events |= POLLOUT;
+    ? m_poll[SOCK_SLOT].events &= ~POLLOUT
+    : m_poll[SOCK_SLOT].events |= POLLOUT;
+}
+
+/// <summary>
+/// Resets the eventfd and sends what Send() queued right away, instead of
+/// waiting a round for POLLOUT. Returns false if a stop was requested.
+/// </summary>
+bool ChatClient::HandleWakeup()
+{
+  if (m_poll[WAKE_SLOT].revents == 0)
+    return true;
+
+  uint64_t cnt = 0;
+  if (read(m_wakeFd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+  {
+    perror("read eventfd");
+  }
+
+  if (!m_running.load(std::memory_order::memory_order_acquire))
+    return false;
+
+  return Write();
 }
 
 bool ChatClient::HandleConnection()
 {
-  if (m_poll.revents & (POLLERR | POLLHUP | POLLNVAL))
+  const pollfd& pfd = m_poll[SOCK_SLOT];
+  if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
   {
     return false;
   }
 
-  if (m_poll.revents & POLLIN)
+  if (pfd.revents & POLLIN)
   {
     if (!Read())
     {
@@ -196,7 +265,7 @@ bool ChatClient::HandleConnection()
     }
   }
 
-  if (m_poll.revents & POLLOUT)
+  if (pfd.revents & POLLOUT)
   {
     if (!Write())
     {
@@ -280,8 +349,16 @@ void ChatClient::Send(const std::string& msg)
   if (msg.empty())
     return;
 
+  bool wasEmpty = false;
   {
     std::lock_guard<std::mutex> lg(m_sendMutex);
+    wasEmpty = m_sendQueue.empty();
     m_sendQueue.push_back(msg);
   }
+
+  // A non-empty queue has already signalled or has POLLOUT armed
+  if (wasEmpty)
+  {
+    Wakeup();
+  }
 }
@@ -16,6 +16,7 @@ public:
 
 
   void Start();
+  // Safe from any thread, the loop closes the connection on its way out
   void Stop();
 
   void Send(const std::string& msg);
@@ -23,11 +24,15 @@ public:
 private:
   bool CreateConnection();
   void RunLoop();
+  void Close();
 
   void CreatePoll();
   void SetPollEvents();
+  bool HandleWakeup();
   bool HandleConnection();
 
+  void Wakeup();
+
   bool Read();
   bool Write();
 
@@ -37,7 +42,9 @@ private:
 
   std::atomic<bool> m_running {false};
   int m_socket = -1;
-  pollfd m_poll;
+  // Signalled by Send() and Stop(), so poll() can block without a timeout
+  int m_wakeFd = -1;
+  pollfd m_poll[2]; // socket, eventfd
 
   std::mutex m_sendMutex;
   std::deque<std::string> m_sendQueue;